@@ -42,9 +42,9 @@ class MainApplication : Application(), ReactApplication {
   override fun onCreate() {
     super.onCreate()
 
-    // 提取模型文件到应用缓存目录（native库由ModelExtractor init块自动加载）
-    val modelPath = ModelExtractor.getModelPath(this)
-    Log.i("MainApplication", "Model path: $modelPath")
+    // 注册 APK 中的模型 asset（native库由ModelExtractor init块自动加载）
+    val modelReady = ModelExtractor.registerModel(this)
+    Log.i("MainApplication", "Model ready: $modelReady")
 
     DefaultNewArchitectureEntryPoint.releaseLevel = try {
       ReleaseLevel.valueOf(BuildConfig.REACT_NATIVE_RELEASE_LEVEL.uppercase())
@@ -1,10 +1,9 @@
 package com.anonymous.test_mnn
 
 import android.content.Context
+import android.content.res.AssetManager
 import android.util.Log
 import java.io.File
-import java.io.FileOutputStream
-import java.io.InputStream
 
 object ModelExtractor {
     private const val TAG = "ModelExtractor"
@@ -23,69 +22,40 @@ object ModelExtractor {
     }
 
     /**
-     * 从 assets 提取模型到应用缓存目录
-     * @return 提取后的模型文件路径，失败返回空字符串
+     * 把 APK 的 AssetManager 和模型名交给 C++，native 端直接读取 APK 中的模型
+     * （build.gradle 中 noCompress 'mnn'，模型在 APK 内未压缩，可直接 mmap），不再解压到 cacheDir
+     * @return true 如果 assets 中存在模型
      */
-    fun extractModelIfNeeded(context: Context): String {
-        val cacheDir = context.cacheDir
-        val modelFile = File(cacheDir, MODEL_NAME)
-
-        // 检查是否已存在
-        if (modelFile.exists()) {
-            Log.i(TAG, "Model already exists: ${modelFile.absolutePath}")
-            return modelFile.absolutePath
-        }
-
-        // 从 assets 提取
-        Log.i(TAG, "Extracting model from assets...")
-        try {
-            val inputStream: InputStream = context.assets.open(MODEL_NAME)
-            val outputStream = FileOutputStream(modelFile)
-
-            val buffer = ByteArray(8192)
-            var bytesRead: Int
-            while (inputStream.read(buffer).also { bytesRead = it } != -1) {
-                outputStream.write(buffer, 0, bytesRead)
-            }
-
-            outputStream.close()
-            inputStream.close()
-
-            Log.i(TAG, "Model extracted to: ${modelFile.absolutePath}")
-            return modelFile.absolutePath
-        } catch (e: Exception) {
-            Log.e(TAG, "Failed to extract model: ${e.message}", e)
-            return ""
+    fun registerModel(context: Context): Boolean {
+        // 删除旧版本解压到 cacheDir 的模型副本
+        val staleCopy = File(context.cacheDir, MODEL_NAME)
+        if (staleCopy.exists() && staleCopy.delete()) {
+            Log.i(TAG, "Removed extracted model copy: ${staleCopy.absolutePath}")
         }
-    }
 
-    /**
-     * 获取模型文件路径（如果不存在则自动提取）
-     * @return 模型文件的完整路径
-     */
-    fun getModelPath(context: Context): String {
-        val path = extractModelIfNeeded(context)
-        if (path.isNotEmpty()) {
-            // 设置给 C++
-            nativeSetModelPath(path)
-            Log.i(TAG, "Model path set via JNI: $path")
-        } else {
-            Log.e(TAG, "Failed to get model path")
+        if (!isModelReady(context)) {
+            Log.e(TAG, "Model not found in assets: $MODEL_NAME")
+            return false
         }
-        return path
+        nativeSetModelAsset(context.assets, MODEL_NAME, context.cacheDir.absolutePath)
+        Log.i(TAG, "Model asset set via JNI: $MODEL_NAME")
+        return true
     }
 
     /**
      * 检查模型是否已准备好
-     * @return true 如果模型文件存在
+     * @return true 如果 assets 中存在模型
      */
     fun isModelReady(context: Context): Boolean {
-        val modelFile = File(context.cacheDir, MODEL_NAME)
-        return modelFile.exists()
+        return context.assets.list("")?.contains(MODEL_NAME) == true
     }
 
     /**
-     * Native 方法声明：设置模型路径供 C++ 使用
+     * Native 方法声明：设置 AssetManager、模型名和缓存目录供 C++ 使用
      */
-    private external fun nativeSetModelPath(modelPath: String)
+    private external fun nativeSetModelAsset(
+        assetManager: AssetManager,
+        modelName: String,
+        cacheDir: String
+    )
 }
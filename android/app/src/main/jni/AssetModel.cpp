@@ -0,0 +1,42 @@
+#include "AssetModel.h"
+
+AssetModel::~AssetModel() {
+    close();
+}
+
+bool AssetModel::open(AAssetManager* manager, const char* name) {
+    close();
+    if (manager == nullptr || name == nullptr) {
+        return false;
+    }
+
+    // BUFFER 模式：一次性取得整段数据，未压缩的 asset 会被直接 mmap
+    AAsset* asset = AAssetManager_open(manager, name, AASSET_MODE_BUFFER);
+    if (asset == nullptr) {
+        return false;
+    }
+
+    const void* data = AAsset_getBuffer(asset);
+    off64_t length = AAsset_getLength64(asset);
+    if (data == nullptr || length <= 0) {
+        AAsset_close(asset);
+        return false;
+    }
+
+    asset_ = asset;
+    data_ = data;
+    size_ = static_cast<size_t>(length);
+    // 只有压缩的 asset 才需要分配内存解压
+    mapped_ = AAsset_isAllocated(asset) == 0;
+    return true;
+}
+
+void AssetModel::close() {
+    if (asset_) {
+        AAsset_close(asset_);
+        asset_ = nullptr;
+        data_ = nullptr;
+        size_ = 0;
+        mapped_ = false;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <android/asset_manager.h>
+#include <cstddef>
+#include "ModelSource.h"
+
+/**
+ * 直接读取 APK 中的模型 asset，不解压到磁盘
+ * asset 以 noCompress 方式打包时 AAsset_getBuffer 返回的是 APK 文件的只读映射，
+ * 否则 AAssetManager 会把它解压到一块堆内存中（仍然可用，但失去了零拷贝的好处）。
+ */
+class AssetModel : public facebook::react::ModelSource {
+public:
+    AssetModel() = default;
+    ~AssetModel() override;
+
+    AssetModel(const AssetModel&) = delete;
+    AssetModel& operator=(const AssetModel&) = delete;
+
+    // 打开 asset，失败（不存在或无法读取）时返回 false
+    bool open(AAssetManager* manager, const char* name);
+    void close();
+
+    // asset 是否直接映射自 APK（未压缩）
+    bool mapped() const { return mapped_; }
+
+    const void* data() const override { return data_; }
+    size_t size() const override { return size_; }
+
+private:
+    AAsset* asset_ = nullptr;
+    const void* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+};
@@ -1,50 +1,76 @@
 #include "ModelJni.h"
 #include <jni.h>
 #include <string>
-#include <android/log.h>
+#include <android/asset_manager_jni.h>
+#include "Log.h"
 
 #define TAG "ModelJni"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
 
 extern "C" {
 
-// 全局变量保存模型路径
-static std::string g_model_path;
+// 全局变量保存 AssetManager、模型名和缓存目录
+// AAssetManager 指针依赖 Java 端 AssetManager 对象存活，因此持有其全局引用
+static jobject g_asset_manager_ref = nullptr;
+static AAssetManager* g_asset_manager = nullptr;
+static std::string g_model_name;
+static std::string g_cache_dir;
+
+static std::string toStdString(JNIEnv* env, jstring str) {
+    const char* chars = env->GetStringUTFChars(str, nullptr);
+    std::string result(chars);
+    env->ReleaseStringUTFChars(str, chars);
+    return result;
+}
 
 /**
- * JNI 方法：设置模型路径（从 Java 调用）
+ * JNI 方法：设置模型 asset 和缓存目录（从 Java 调用）
  */
 JNIEXPORT void JNICALL
-Java_com_anonymous_test_1mnn_ModelExtractor_nativeSetModelPath(
+Java_com_anonymous_test_1mnn_ModelExtractor_nativeSetModelAsset(
     JNIEnv* env,
     jclass clazz,
-    jstring modelPath) {
-    LOGI("JNI: nativeSetModelPath called");
-
-    if (modelPath == nullptr) {
-        LOGE("JNI: modelPath parameter is null!");
+    jobject assetManager,
+    jstring modelName,
+    jstring cacheDir) {
+    if (assetManager == nullptr || modelName == nullptr || cacheDir == nullptr) {
+        LOGE("JNI: nativeSetModelAsset called with null parameter!");
         return;
     }
 
-    const char* pathChars = env->GetStringUTFChars(modelPath, nullptr);
-    g_model_path = std::string(pathChars);
-    env->ReleaseStringUTFChars(modelPath, pathChars);
+    if (g_asset_manager_ref != nullptr) {
+        env->DeleteGlobalRef(g_asset_manager_ref);
+    }
+    g_asset_manager_ref = env->NewGlobalRef(assetManager);
+    g_asset_manager = AAssetManager_fromJava(env, g_asset_manager_ref);
+    g_model_name = toStdString(env, modelName);
+    g_cache_dir = toStdString(env, cacheDir);
+
+    LOGI("JNI: Model asset set to: %s, cache dir: %s", g_model_name.c_str(), g_cache_dir.c_str());
+}
 
-    LOGI("JNI: Model path set to: %s (length: %zu)", g_model_path.c_str(), g_model_path.length());
+/**
+ * 获取 AAssetManager（从 C++ 调用）
+ */
+AAssetManager* getAssetManager() {
+    return g_asset_manager;
 }
 
 /**
- * JNI 方法：获取模型路径（从 C++ 调用）
+ * 获取模型 asset 名（从 C++ 调用）
  */
-const char* getModelPath() {
-    LOGI("JNI: getModelPath() called, g_model_path.empty()=%s", g_model_path.empty() ? "true" : "false");
-    if (g_model_path.empty()) {
-        LOGE("JNI: g_model_path is empty, returning nullptr");
+const char* getModelAssetName() {
+    if (g_model_name.empty()) {
+        LOGE("JNI: model asset name is not set");
         return nullptr;
     }
-    LOGI("JNI: Returning model path: %s", g_model_path.c_str());
-    return g_model_path.c_str();
+    return g_model_name.c_str();
+}
+
+/**
+ * 获取缓存目录（从 C++ 调用）
+ */
+const char* getCacheDir() {
+    return g_cache_dir.empty() ? nullptr : g_cache_dir.c_str();
 }
 
 } // extern "C"
@@ -1,9 +1,22 @@
 #pragma once
 
+#include <android/asset_manager.h>
 #include <cstdlib>
 
 /**
- * 获取模型文件路径
- * @return 模型文件的完整路径，如果未设置则返回 nullptr
+ * 获取 APK 的 AAssetManager
+ * @return 由 ModelExtractor.registerModel() 设置，未设置时返回 nullptr
  */
-extern "C" const char* getModelPath();
+extern "C" AAssetManager* getAssetManager();
+
+/**
+ * 获取模型在 assets 中的文件名
+ * @return 例如 "RFB-320.mnn"，未设置时返回 nullptr
+ */
+extern "C" const char* getModelAssetName();
+
+/**
+ * 获取应用缓存目录（保存调优结果等）
+ * @return 缓存目录的完整路径，未设置时返回 nullptr
+ */
+extern "C" const char* getCacheDir();
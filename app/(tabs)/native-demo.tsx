@@ -1,4 +1,4 @@
-import NativeSampleModule from '@/specs/NativeSampleModule';
+import NativeSampleModule, { FaceBox } from '@/specs/NativeSampleModule';
 import { Asset } from 'expo-asset';
 import React, { useEffect, useState } from 'react';
 import {
@@ -24,6 +24,7 @@ export default function NativeDemoScreen() {
   const [initResult, setInitResult] = useState('');
   const [imagePath, setImagePath] = useState('');
   const [faceResult, setFaceResult] = useState('');
+  const [formatResult, setFormatResult] = useState('');
 
   // 获取测试图片的本地路径
   useEffect(() => {
@@ -95,11 +96,11 @@ export default function NativeDemoScreen() {
     }
   };
 
-  const onInitDetectorPress = () => {
+  const onInitDetectorPress = async () => {
     try {
       console.log('=== Init Face Detector ===');
-      // 不再需要传递模型路径，自动从 assets 加载
-      const result = NativeSampleModule.initFaceDetector();
+      // 不再需要传递模型路径，自动从 assets 加载；异步执行，不阻塞 UI
+      const result = await NativeSampleModule.initFaceDetectorAsync();
       console.log('Result:', result);
 
       setInitResult(result);
@@ -109,12 +110,12 @@ export default function NativeDemoScreen() {
     }
   };
 
-  const onDetectFacePress = () => {
+  const onDetectFacePress = async () => {
     try {
       console.log('=== Face Detection Debug ===');
       console.log('Image path:', imagePath);
 
-      const result = NativeSampleModule.detectFace(imagePath);
+      const result = await NativeSampleModule.detectFaceAsync(imagePath);
       console.log('Result:', result);
 
       setFaceResult(result);
@@ -124,6 +125,43 @@ export default function NativeDemoScreen() {
     }
   };
 
+  // 比较三种结果格式从调用到 JS 拿到可用数据的耗时
+  const onCompareFormatsPress = () => {
+    const iterations = 30;
+    const measure = (run: () => number) => {
+      run(); // 预热
+      let faces = 0;
+      const start = performance.now();
+      for (let i = 0; i < iterations; i++) {
+        faces = run();
+      }
+      return { ms: (performance.now() - start) / iterations, faces };
+    };
+
+    try {
+      const json = measure(() => {
+        const parsed = JSON.parse(NativeSampleModule.detectFace(imagePath));
+        return parsed.faces.length;
+      });
+      const objects = measure(() => {
+        const faces = NativeSampleModule.detectFaceTyped(imagePath, false) as FaceBox[];
+        return faces.length;
+      });
+      const packed = measure(() => {
+        const data = NativeSampleModule.detectFaceTyped(imagePath, true) as Float32Array;
+        return data.length / 5;
+      });
+      setFormatResult(
+        `JSON string + parse: ${json.ms.toFixed(2)} ms (${json.faces} faces)\n` +
+        `Array of objects: ${objects.ms.toFixed(2)} ms (${objects.faces} faces)\n` +
+        `Packed Float32Array: ${packed.ms.toFixed(2)} ms (${packed.faces} faces)`,
+      );
+    } catch (error) {
+      console.error('Error comparing result formats:', error);
+      setFormatResult('Error: ' + String(error));
+    }
+  };
+
   return (
     <SafeAreaView style={styles.container}>
       <View>
@@ -181,6 +219,10 @@ export default function NativeDemoScreen() {
         <Text style={styles.result}>Detection result:</Text>
         <Text style={styles.faceResult}>{faceResult || 'No result yet'}</Text>
 
+        <Text style={styles.hint}>Step 3: Compare result formats (sync, 30 runs each):</Text>
+        <Button title="Compare Result Formats" onPress={onCompareFormatsPress} />
+        <Text style={styles.faceResult}>{formatResult || 'No comparison yet'}</Text>
+
         <Text style={styles.debug}>Debug info:{'\n'}{debugInfo}</Text>
       </View>
     </SafeAreaView>
@@ -0,0 +1,197 @@
+// anchor 解码微基准
+//
+// 用法: decode_bench [--iters N] [--rate R]
+//
+// 用合成的模型输出（RFB-320, 320x240, 4420 个 anchor）比较四种解码实现：
+//   legacy  原实现：vector<vector<float>> anchors + 逐字段 host<float>() + std::exp
+//   scalar  SoA anchors + 标量 fastExp
+//   simd    SoA anchors + SIMD 阈值筛选 / 解码（运行时通用路径）
+//   fixed   FixedDecoder<UltraFaceRfb320>：编译期 anchor 表 + 常量 anchor 数 / 方差
+// 并校验 scalar / simd / fixed 的输出逐位一致、编译期 anchor 表与 generateAnchors() 一致。
+// R 为分数超过阈值的 anchor 比例。
+
+#include "AnchorDecoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace facebook::react;
+
+namespace {
+
+constexpr int kWidth = 320;
+constexpr int kHeight = 240;
+constexpr int kImageWidth = 1920;
+constexpr int kImageHeight = 1080;
+constexpr float kScoreThreshold = 0.95f;
+
+// 简单 LCG，保证每次运行数据一致
+struct Random {
+    uint32_t state = 12345;
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+float clipLegacy(float x, float y) {
+    return x < 0 ? 0 : (x > y ? y : x);
+}
+
+// 原实现（仅保留解码部分）
+void decodeLegacy(const float* scores, const float* boxes,
+                  const std::vector<std::vector<float>>& anchors,
+                  std::vector<FaceInfo>* faces) {
+    const float centerVariance = 0.1f;
+    const float sizeVariance = 0.2f;
+    int width = kImageWidth;
+    int height = kImageHeight;
+    for (size_t i = 0; i < anchors.size(); ++i) {
+        float score = scores[2 * i + 1];
+        if (score <= kScoreThreshold) continue;
+        float centerX = boxes[4 * i] * centerVariance * anchors[i][2] + anchors[i][0];
+        float centerY = boxes[4 * i + 1] * centerVariance * anchors[i][3] + anchors[i][1];
+        float centerW = exp(boxes[4 * i + 2] * sizeVariance) * anchors[i][2];
+        float centerH = exp(boxes[4 * i + 3] * sizeVariance) * anchors[i][3];
+        int fx = static_cast<int>(clipLegacy(centerX - centerW / 2.0f, 1.0f) * width);
+        int fy = static_cast<int>(clipLegacy(centerY - centerH / 2.0f, 1.0f) * height);
+        int fw = static_cast<int>(clipLegacy(centerW, 1.0f) * width);
+        int fh = static_cast<int>(clipLegacy(centerH, 1.0f) * height);
+        int maxSide = std::max(fw, fh);
+        FaceInfo info;
+        info.x = clipLegacy(fx + 0.5f * fw - 0.5f * maxSide, width - maxSide);
+        info.y = clipLegacy(fy + 0.5f * fh - 0.5f * maxSide, height - maxSide);
+        info.width = maxSide;
+        info.height = maxSide;
+        info.score = clipLegacy(score, 1.0f);
+        faces->push_back(info);
+    }
+}
+
+template <typename Fn>
+double timeUs(int iters, Fn&& fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; ++i) fn();
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - t0).count() / iters;
+}
+
+bool sameFaces(const std::vector<FaceInfo>& a, const std::vector<FaceInfo>& b) {
+    return a.size() == b.size() &&
+           (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(FaceInfo)) == 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iters = 5000;
+    float rate = 0.02f;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--iters") && i + 1 < argc) {
+            iters = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            rate = static_cast<float>(atof(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--iters N] [--rate R]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<std::vector<float>> minBoxes = {
+        {10.0f, 16.0f, 24.0f}, {32.0f, 48.0f}, {64.0f, 96.0f}, {128.0f, 192.0f, 256.0f}};
+    std::vector<float> strides = {8.0f, 16.0f, 32.0f, 64.0f};
+    AnchorTable anchors;
+    // 通用路径在 init 时生成 anchors，特化路径没有这一步
+    double generateUs = timeUs(std::max(1, iters / 10), [&] {
+        generateAnchors(kWidth, kHeight, minBoxes, strides, &anchors);
+    });
+    const int numAnchors = static_cast<int>(anchors.size());
+
+    using Fixed = FixedDecoder<UltraFaceRfb320>;
+    const auto& fixedAnchors = Fixed::anchors();
+    bool sameAnchors = numAnchors == Fixed::kNumAnchors;
+    for (int i = 0; sameAnchors && i < numAnchors; ++i) {
+        sameAnchors = anchors.cx[i] == fixedAnchors.cx[i] && anchors.cy[i] == fixedAnchors.cy[i] &&
+                      anchors.w[i] == fixedAnchors.w[i] && anchors.h[i] == fixedAnchors.h[i];
+    }
+
+    std::vector<std::vector<float>> legacyAnchors(numAnchors);
+    for (int i = 0; i < numAnchors; ++i) {
+        legacyAnchors[i] = {anchors.cx[i], anchors.cy[i], anchors.w[i], anchors.h[i]};
+    }
+
+    Random rng;
+    std::vector<float> scores(2 * numAnchors);
+    std::vector<float> boxes(4 * numAnchors);
+    for (int i = 0; i < numAnchors; ++i) {
+        float face = rng.next() < rate ? kScoreThreshold + 0.05f * rng.next()
+                                       : kScoreThreshold * rng.next();
+        scores[2 * i] = 1.0f - face;
+        scores[2 * i + 1] = face;
+    }
+    for (auto& b : boxes) b = 4.0f * rng.next() - 2.0f;
+
+    DecodeParams params;
+    params.scoreThreshold = kScoreThreshold;
+    params.imageWidth = kImageWidth;
+    params.imageHeight = kImageHeight;
+
+    std::vector<int> indices;
+    std::vector<FaceInfo> legacyFaces, scalarFaces, simdFaces, fixedFaces;
+
+    double legacyUs = timeUs(iters, [&] {
+        legacyFaces.clear();
+        decodeLegacy(scores.data(), boxes.data(), legacyAnchors, &legacyFaces);
+    });
+    double scalarUs = timeUs(iters, [&] {
+        selectCandidatesScalar(scores.data(), numAnchors, kScoreThreshold, &indices);
+        scalarFaces.clear();
+        decodeCandidatesScalar(scores.data(), boxes.data(), anchors, indices, params, &scalarFaces);
+    });
+    double simdUs = timeUs(iters, [&] {
+        selectCandidates(scores.data(), numAnchors, kScoreThreshold, &indices);
+        simdFaces.clear();
+        decodeCandidates(scores.data(), boxes.data(), anchors, indices, params, &simdFaces);
+    });
+    double fixedUs = timeUs(iters, [&] {
+        Fixed::select(scores.data(), kScoreThreshold, &indices);
+        fixedFaces.clear();
+        Fixed::decode(scores.data(), boxes.data(), indices, params, &fixedFaces);
+    });
+
+    // fastExp 与 std::exp 的最大相对误差（模型输出范围内）
+    float maxRelErr = 0;
+    for (float x = -4.0f; x <= 4.0f; x += 1e-3f) {
+        float ref = std::exp(x);
+        maxRelErr = std::max(maxRelErr, std::fabs(fastExp(x) - ref) / ref);
+    }
+    int maxPixelDiff = 0;
+    if (legacyFaces.size() == scalarFaces.size()) {
+        for (size_t i = 0; i < legacyFaces.size(); ++i) {
+            maxPixelDiff = std::max(maxPixelDiff, static_cast<int>(std::fabs(
+                legacyFaces[i].width - scalarFaces[i].width)));
+        }
+    }
+
+    bool identical = sameFaces(scalarFaces, simdFaces);
+    bool fixedIdentical = sameFaces(simdFaces, fixedFaces);
+    printf("anchors: %d, candidates: %zu, simd: %s, iters: %d\n",
+           numAnchors, simdFaces.size(), decoderSimdName(), iters);
+    printf("%-8s %10s\n", "impl", "us/frame");
+    printf("%-8s %10.3f\n", "legacy", legacyUs);
+    printf("%-8s %10.3f\n", "scalar", scalarUs);
+    printf("%-8s %10.3f\n", "simd", simdUs);
+    printf("%-8s %10.3f\n", "fixed", fixedUs);
+    printf("generateAnchors: %.3f us per init (fixed: 0, table is constexpr)\n", generateUs);
+    printf("scalar == simd: %s\n", identical ? "yes" : "NO");
+    printf("simd == fixed: %s, constexpr anchors == generateAnchors: %s\n",
+           fixedIdentical ? "yes" : "NO", sameAnchors ? "yes" : "NO");
+    printf("fastExp max rel err: %.3g, max box size diff vs legacy: %d px\n",
+           maxRelErr, maxPixelDiff);
+    return identical && fixedIdentical && sameAnchors ? 0 : 1;
+}
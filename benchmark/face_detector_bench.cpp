@@ -0,0 +1,951 @@
+// NativeFaceDetector 宿主机基准测试
+//
+// 用法: face_detector_bench <model.mnn> <image_dir> [--iters N] [--warmup N]
+//                            [--preprocess fused|resize] [--filter nearest|bilinear|bicubic]
+//                            [--nms greedy|soft-linear|soft-gaussian|weighted]
+//                            [--batch 1,4,8,16] [--workers 1,2,4,8]
+//                            [--threads N] [--precision normal|high|low] [--input WxH]
+//                            [--autotune <cache_dir>] [--load mmap|memory|legacy]
+//                            [--switch <budget_mb,...>] [--letterbox] [--sizes WxH,...]
+//                            [--track <interval,...>] [--regions <expand>]
+//                            [--tiled <batch,...>] [--cache <dir>] [--scan <threads,...>]
+//                            [--ops <topN>]
+//
+// 对目录下每张图片重复调用 detect()，统计各阶段耗时的 p50/p95/p99。
+// 指定 --batch 时，额外用 detectBatch() 按每个批大小测量吞吐（images/sec）。
+// 指定 --autotune 时，先以第一张图片为参考图运行 DetectorTuner（或读取已保存的结果），
+// 再用选中的线程数 / 精度 / 滤波器跑上述测试。
+// --load legacy 模拟原加载方式（整个文件读入堆、保留解释器中的模型缓冲），
+// 用于和默认的 mmap + releaseModel() 对比 init 耗时和常驻内存。
+// --load memory 先把模型读入 MemoryModel 再 init(ModelSource)，与 Android 从 APK asset
+// 加载走同一条路径（asset 缓冲 → createFromBuffer → releaseModel()）。
+// 指定 --workers 时，对每个线程数 N 创建一个含 N 个 session 的检测器，
+// N 个线程并发调用 detect()，输出吞吐随线程数的扩展曲线。
+// 指定 --switch 时，把模型以两种输入尺寸（fast: --input，accurate: 宽高各加倍）注册到
+// ModelRegistry，交替取用并检测，对比每个预算下切换的平均耗时和加载 / 淘汰次数。
+// --letterbox 让所有检测保持宽高比缩放（补黑边）而不是拉伸到输入尺寸。
+// 指定 --sizes 时，对每个输入尺寸分别计时首次检测（含生成 anchors；session 已在 init 中
+// 创建）和之后的平均耗时。
+// 指定 --track 时，用第一张图片合成一段平移 / 缩放的视频，按每个全量检测间隔运行 FaceTracker，
+// 输出每帧平均耗时、检测次数、与逐帧检测结果的平均 IoU 和产生的轨迹 ID 数。
+// 指定 --regions 时，以每张图片的整帧检测结果为区域调用 detectInRegions()，对比耗时和检出数。
+// 指定 --tiled 时，把所有图片缩小后拼成一张 4000x3000 的“合照”，以每张小图单独检测的结果为
+// 真值，对比整图 detect() 与按每个批大小运行的 detectTiled() 的耗时、检出数和召回率。
+// 指定 --cache 时，对每个图片文件测量未命中（加载 + 检测 + 写入缓存）、内存层命中和
+// 磁盘层命中（在同一目录上新建的 ResultCache）的平均耗时。
+// 指定 --scan 时，把图片列表重复到至少 256 张，对比逐张串行加载 + 检测与 ScanPipeline
+// （按每个解码线程数）的吞吐。
+// 指定 --ops 时，开启逐算子计时对每张图片再跑 --iters 次，输出按算子类型汇总的耗时占比 /
+// GFLOP/s 和耗时最高的 topN 个算子。
+
+#include "DetectorTuner.h"
+#include "FaceTracker.h"
+#include "MappedModel.h"
+#include "ModelRegistry.h"
+#include "NativeFaceDetector.h"
+#include "ImageLoader.h"
+#include "ResultCache.h"
+#include "ScanPipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using facebook::react::DetectorOptions;
+using facebook::react::DetectorTuner;
+using facebook::react::TuneResult;
+using facebook::react::DetectProfile;
+using facebook::react::FaceInfo;
+using facebook::react::FaceTracker;
+using facebook::react::InputConfig;
+using facebook::react::MappedModel;
+using facebook::react::MemoryModel;
+using facebook::react::ModelRegistry;
+using facebook::react::ModelSource;
+using facebook::react::ModelSpec;
+using facebook::react::NativeFaceDetector;
+using facebook::react::NmsConfig;
+using facebook::react::NmsMode;
+using facebook::react::PreprocessMode;
+using facebook::react::ResultCache;
+using facebook::react::ScanConfig;
+using facebook::react::ScanPipeline;
+using facebook::react::ScanProgress;
+using facebook::react::TrackedFace;
+using facebook::react::TrackerOptions;
+
+namespace {
+
+struct Options {
+    std::string modelPath;
+    std::string imageDir;
+    int iters = 20;
+    int warmup = 3;
+    PreprocessMode preprocess = PreprocessMode::Fused;
+    MNN::CV::Filter filter = MNN::CV::BILINEAR;
+    NmsMode nms = NmsMode::Greedy;
+    std::vector<int> batchSizes;
+    std::vector<int> workerCounts;
+    DetectorOptions detector;
+    std::string tuneCacheDir;
+    std::string loadMode = "mmap";  // mmap | memory | legacy
+    std::vector<int> switchBudgetsMb;
+    bool letterbox = false;
+    std::vector<std::pair<int, int>> inputSizes;
+    std::vector<int> trackIntervals;
+    float regionExpand = 0;  // > 0 时测量 detectInRegions()
+    std::vector<int> tileBatches;
+    std::string cacheDir;
+    std::vector<int> scanDecodeThreads;
+    int opsTopN = 0;  // > 0 时输出逐算子耗时
+};
+
+void printUsage(const char* argv0) {
+    fprintf(stderr, "usage: %s <model.mnn> <image_dir> [--iters N] [--warmup N]\n"
+                    "       [--preprocess fused|resize] [--filter nearest|bilinear|bicubic]\n"
+                    "       [--nms greedy|soft-linear|soft-gaussian|weighted]\n"
+                    "       [--batch 1,4,8,16] [--workers 1,2,4,8]\n"
+                    "       [--threads N] [--precision normal|high|low] [--input WxH]\n"
+                    "       [--autotune <cache_dir>] [--load mmap|memory|legacy]\n"
+                    "       [--switch <budget_mb,...>] [--letterbox] [--sizes WxH,...]\n"
+                    "       [--track <interval,...>] [--regions <expand>]\n"
+                    "       [--tiled <batch,...>] [--cache <dir>] [--scan <threads,...>]\n"
+                    "       [--ops <topN>]\n",
+            argv0);
+}
+
+bool parseFilter(const char* name, MNN::CV::Filter* filter) {
+    if (!strcmp(name, "nearest")) {
+        *filter = MNN::CV::NEAREST;
+    } else if (!strcmp(name, "bilinear")) {
+        *filter = MNN::CV::BILINEAR;
+    } else if (!strcmp(name, "bicubic")) {
+        *filter = MNN::CV::BICUBIC;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseNms(const char* name, NmsMode* mode) {
+    if (!strcmp(name, "greedy")) {
+        *mode = NmsMode::Greedy;
+    } else if (!strcmp(name, "soft-linear")) {
+        *mode = NmsMode::SoftLinear;
+    } else if (!strcmp(name, "soft-gaussian")) {
+        *mode = NmsMode::SoftGaussian;
+    } else if (!strcmp(name, "weighted")) {
+        *mode = NmsMode::Weighted;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseIntList(const char* list, std::vector<int>* sizes) {
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int n = atoi(item.c_str());
+        if (n <= 0) return false;
+        sizes->push_back(n);
+    }
+    return !sizes->empty();
+}
+
+bool parseSizeList(const char* list, std::vector<std::pair<int, int>>* sizes) {
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int w = 0, h = 0;
+        if (sscanf(item.c_str(), "%dx%d", &w, &h) != 2 || w < 2 || h < 2) return false;
+        sizes->emplace_back(w, h);
+    }
+    return !sizes->empty();
+}
+
+bool parseArgs(int argc, char** argv, Options* opts) {
+    if (argc < 3) return false;
+    opts->modelPath = argv[1];
+    opts->imageDir = argv[2];
+    for (int i = 3; i < argc; ++i) {
+        if (!strcmp(argv[i], "--iters") && i + 1 < argc) {
+            opts->iters = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--warmup") && i + 1 < argc) {
+            opts->warmup = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--preprocess") && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (!strcmp(mode, "fused")) {
+                opts->preprocess = PreprocessMode::Fused;
+            } else if (!strcmp(mode, "resize")) {
+                opts->preprocess = PreprocessMode::ResizeThenConvert;
+            } else {
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--filter") && i + 1 < argc) {
+            if (!parseFilter(argv[++i], &opts->filter)) return false;
+        } else if (!strcmp(argv[i], "--nms") && i + 1 < argc) {
+            if (!parseNms(argv[++i], &opts->nms)) return false;
+        } else if (!strcmp(argv[i], "--batch") && i + 1 < argc) {
+            if (!parseIntList(argv[++i], &opts->batchSizes)) return false;
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            opts->detector.numThreads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--precision") && i + 1 < argc) {
+            const char* precision = argv[++i];
+            if (!strcmp(precision, "normal")) {
+                opts->detector.precision = MNN::BackendConfig::Precision_Normal;
+            } else if (!strcmp(precision, "high")) {
+                opts->detector.precision = MNN::BackendConfig::Precision_High;
+            } else if (!strcmp(precision, "low")) {
+                opts->detector.precision = MNN::BackendConfig::Precision_Low;
+            } else {
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--input") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &opts->detector.inputWidth,
+                       &opts->detector.inputHeight) != 2) {
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--load") && i + 1 < argc) {
+            opts->loadMode = argv[++i];
+            if (opts->loadMode != "mmap" && opts->loadMode != "memory" &&
+                opts->loadMode != "legacy") {
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--autotune") && i + 1 < argc) {
+            opts->tuneCacheDir = argv[++i];
+        } else if (!strcmp(argv[i], "--workers") && i + 1 < argc) {
+            if (!parseIntList(argv[++i], &opts->workerCounts)) return false;
+        } else if (!strcmp(argv[i], "--switch") && i + 1 < argc) {
+            if (!parseIntList(argv[++i], &opts->switchBudgetsMb)) return false;
+        } else if (!strcmp(argv[i], "--letterbox")) {
+            opts->letterbox = true;
+        } else if (!strcmp(argv[i], "--sizes") && i + 1 < argc) {
+            if (!parseSizeList(argv[++i], &opts->inputSizes)) return false;
+        } else if (!strcmp(argv[i], "--track") && i + 1 < argc) {
+            if (!parseIntList(argv[++i], &opts->trackIntervals)) return false;
+        } else if (!strcmp(argv[i], "--regions") && i + 1 < argc) {
+            opts->regionExpand = static_cast<float>(atof(argv[++i]));
+            if (opts->regionExpand <= 0) return false;
+        } else if (!strcmp(argv[i], "--tiled") && i + 1 < argc) {
+            if (!parseIntList(argv[++i], &opts->tileBatches)) return false;
+        } else if (!strcmp(argv[i], "--cache") && i + 1 < argc) {
+            opts->cacheDir = argv[++i];
+        } else if (!strcmp(argv[i], "--ops") && i + 1 < argc) {
+            opts->opsTopN = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--scan") && i + 1 < argc) {
+            if (!parseIntList(argv[++i], &opts->scanDecodeThreads)) return false;
+        } else {
+            return false;
+        }
+    }
+    // 与应用相同释放模型缓冲，批大小和其他输入尺寸的 session 在 init 中创建；
+    // legacy 加载方式保留模型缓冲
+    opts->detector.batchSizes = opts->batchSizes;
+    opts->detector.inputSizes = opts->inputSizes;
+    if (opts->loadMode == "legacy") {
+        opts->detector.releaseModelAfterInit = false;
+    }
+    return opts->iters > 0 && opts->warmup >= 0;
+}
+
+std::vector<std::string> listImages(const std::string& dir) {
+    static const char* kExts[] = {".jpg", ".jpeg", ".png", ".bmp"};
+    std::vector<std::string> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (!entry.is_regular_file()) continue;
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        for (const char* e : kExts) {
+            if (ext == e) {
+                paths.push_back(entry.path().string());
+                break;
+            }
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+// 最近秩法求百分位，samples 会被排序
+double percentile(std::vector<double>* samples, double p) {
+    if (samples->empty()) return 0;
+    std::sort(samples->begin(), samples->end());
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples->size()));
+    return (*samples)[std::min(samples->size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+// 当前常驻内存（MB）
+double currentRssMb() {
+    long pages = 0, residentPages = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    if (fscanf(statm, "%ld %ld", &pages, &residentPages) != 2) residentPages = 0;
+    fclose(statm);
+    return residentPages * (sysconf(_SC_PAGESIZE) / 1024.0) / 1024.0;
+}
+
+// 进程峰值常驻内存（MB）
+double peakRssMb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;  // Linux 下单位为 KB
+}
+
+// N 个线程共享一个 N-session 检测器，处理 images.size() * iters 张图像，返回 images/sec
+double measureConcurrent(const Options& opts, const std::vector<cv::Mat>& images, int workers) {
+    NativeFaceDetector detector;
+    detector.setSessionCount(workers);
+    detector.setPreprocess(opts.preprocess, opts.filter);
+    NmsConfig nmsConfig;
+    nmsConfig.mode = opts.nms;
+    detector.setNms(nmsConfig);
+    if (detector.init(opts.modelPath, opts.detector) != 0) {
+        return -1;
+    }
+
+    const size_t total = images.size() * opts.iters;
+    auto runAll = [&](size_t count) {
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> threads;
+        for (int w = 0; w < workers; ++w) {
+            threads.emplace_back([&] {
+                std::vector<FaceInfo> faces;
+                for (size_t i = next++; i < count; i = next++) {
+                    detector.detect(images[i % images.size()], &faces);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+    };
+
+    runAll(images.size() * std::max(opts.warmup, 1));
+    auto start = std::chrono::steady_clock::now();
+    runAll(total);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total / seconds;
+}
+
+// 在 fast / accurate 两个模型间交替切换，返回每次切换（acquire + detect）的平均毫秒数
+double measureModelSwitch(const Options& opts, const std::vector<cv::Mat>& images,
+                          int budgetMb, ModelRegistry::Stats* stats) {
+    ModelRegistry registry(static_cast<size_t>(budgetMb) << 20);
+    ModelSpec fast;
+    fast.open = [&opts]() -> std::unique_ptr<ModelSource> {
+        auto model = std::make_unique<MappedModel>();
+        if (!model->map(opts.modelPath)) return nullptr;
+        return model;
+    };
+    fast.options = opts.detector;
+    fast.preprocess = opts.preprocess;
+    fast.filter = opts.filter;
+    ModelSpec accurate = fast;
+    accurate.options.inputWidth *= 2;
+    accurate.options.inputHeight *= 2;
+    registry.add("fast", fast);
+    registry.add("accurate", accurate);
+
+    const char* ids[] = {"fast", "accurate"};
+    std::vector<FaceInfo> faces;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < opts.iters; ++i) {
+        auto detector = registry.acquire(ids[i % 2]);
+        if (!detector) return -1;
+        detector->detect(images[i % images.size()], &faces);
+    }
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count() / opts.iters;
+    *stats = registry.stats();
+    return ms;
+}
+
+// 用 image 合成一段视频：取 70% 大小的窗口沿平滑轨迹平移并轻微缩放
+std::vector<cv::Mat> makeClip(const cv::Mat& image, int frames) {
+    std::vector<cv::Mat> clip(frames);
+    const cv::Size size(image.cols * 7 / 10, image.rows * 7 / 10);
+    for (int i = 0; i < frames; ++i) {
+        double t = 2 * M_PI * i / frames;
+        double zoom = 1.0 + 0.1 * std::sin(2 * t);
+        cv::Size window(static_cast<int>(size.width / zoom), static_cast<int>(size.height / zoom));
+        int x = static_cast<int>((image.cols - window.width) * (0.5 + 0.5 * std::sin(t)));
+        int y = static_cast<int>((image.rows - window.height) * (0.5 + 0.5 * std::cos(t)));
+        cv::resize(image(cv::Rect(x, y, window.width, window.height)), clip[i], size);
+    }
+    return clip;
+}
+
+float iou(const FaceInfo& a, const FaceInfo& b) {
+    float w = std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x);
+    float h = std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y);
+    if (w <= 0 || h <= 0) return 0;
+    return w * h / (a.width * a.height + b.width * b.height - w * h);
+}
+
+struct TrackResult {
+    double msPerFrame = 0;
+    uint64_t detections = 0;
+    double meanIoU = 0;  // 逐帧检测的每个框与跟踪框的最大 IoU 的平均
+    size_t ids = 0;
+};
+
+// 在 clip 上运行 FaceTracker；reference 为每帧全量检测的结果
+bool measureTracking(const std::shared_ptr<NativeFaceDetector>& detector,
+                     const std::vector<cv::Mat>& clip,
+                     const std::vector<std::vector<FaceInfo>>& reference,
+                     const TrackerOptions& options, TrackResult* result) {
+    FaceTracker tracker(detector, options);
+    std::vector<TrackedFace> tracked;
+    std::vector<int> ids;
+    double iouSum = 0;
+    size_t iouCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < clip.size(); ++i) {
+        if (tracker.process(clip[i], &tracked) != 0) return false;
+        for (const TrackedFace& t : tracked) ids.push_back(t.id);
+        for (const FaceInfo& ref : reference[i]) {
+            float best = 0;
+            for (const TrackedFace& t : tracked) best = std::max(best, iou(ref, t.face));
+            iouSum += best;
+            ++iouCount;
+        }
+    }
+    result->msPerFrame = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count() / clip.size();
+    result->detections = tracker.detections();
+    result->meanIoU = iouCount ? iouSum / iouCount : 0;
+    std::sort(ids.begin(), ids.end());
+    result->ids = std::unique(ids.begin(), ids.end()) - ids.begin();
+    return true;
+}
+
+// 合成的大图及其真值框
+struct GroupPhoto {
+    cv::Mat image;
+    std::vector<FaceInfo> truth;
+};
+
+// 把 images 循环缩小到 cell 大小，铺满 width x height 的画布；每个格子单独检测
+// （小图送入模型时基本不缩小）的结果平移到画布坐标后作为真值
+GroupPhoto makeGroupPhoto(NativeFaceDetector& detector, const std::vector<cv::Mat>& images,
+                          int width, int height, cv::Size cell) {
+    GroupPhoto photo;
+    photo.image = cv::Mat(height, width, CV_8UC3, cv::Scalar::all(0));
+    std::vector<FaceInfo> faces;
+    size_t next = 0;
+    for (int y = 0; y + cell.height <= height; y += cell.height) {
+        for (int x = 0; x + cell.width <= width; x += cell.width) {
+            cv::Mat target = photo.image(cv::Rect(x, y, cell.width, cell.height));
+            cv::resize(images[next++ % images.size()], target, cell, 0, 0, cv::INTER_AREA);
+            detector.detect(target, &faces);
+            for (FaceInfo face : faces) {
+                face.x += x;
+                face.y += y;
+                photo.truth.push_back(face);
+            }
+        }
+    }
+    return photo;
+}
+
+// 真值框中与 faces 里某个框 IoU >= 0.5 的比例
+double recall(const std::vector<FaceInfo>& truth, const std::vector<FaceInfo>& faces) {
+    if (truth.empty()) return 0;
+    size_t hit = 0;
+    for (const FaceInfo& t : truth) {
+        for (const FaceInfo& f : faces) {
+            if (iou(t, f) >= 0.5f) {
+                ++hit;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(hit) / truth.size();
+}
+
+struct StageSamples {
+    const char* name;
+    double DetectProfile::*field;
+    std::vector<double> samples;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, &opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<cv::Mat> images;
+    for (const auto& path : listImages(opts.imageDir)) {
+        cv::Mat img = cv::imread(path);
+        if (img.empty()) {
+            fprintf(stderr, "skip unreadable image: %s\n", path.c_str());
+            continue;
+        }
+        images.push_back(img);
+    }
+    if (images.empty()) {
+        fprintf(stderr, "no images found in %s\n", opts.imageDir.c_str());
+        return 1;
+    }
+
+    if (!opts.tuneCacheDir.empty()) {
+        DetectorTuner tuner(opts.tuneCacheDir);
+        TuneResult tuned;
+        MappedModel model;
+        if (!model.map(opts.modelPath)) {
+            fprintf(stderr, "failed to map model: %s\n", opts.modelPath.c_str());
+            return 1;
+        }
+        auto tuneStart = std::chrono::steady_clock::now();
+        if (tuner.tune(model, images.front(), opts.detector, &tuned) != 0) {
+            fprintf(stderr, "auto-tune failed\n");
+            return 1;
+        }
+        double tuneMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - tuneStart).count();
+        printf("auto-tune (%s, %.0f ms): threads=%d precision=%d filter=%d detect=%.2f ms\n",
+               tuned.fromCache ? "cached" : "measured", tuneMs, tuned.options.numThreads,
+               tuned.options.precision, tuned.filter, tuned.detectMs);
+        opts.detector = tuned.options;
+        opts.filter = tuned.filter;
+        opts.preprocess = PreprocessMode::Fused;
+    }
+
+    double loadedRssMb = currentRssMb();
+
+    NativeFaceDetector detector;
+    detector.setPreprocess(opts.preprocess, opts.filter);
+    NmsConfig nmsConfig;
+    nmsConfig.mode = opts.nms;
+    detector.setNms(nmsConfig);
+    auto t0 = std::chrono::steady_clock::now();
+    int ret;
+    if (opts.loadMode == "legacy") {
+        // 与 createFromFile 相同：整个文件读入堆，模型缓冲保留在解释器中
+        std::ifstream file(opts.modelPath, std::ios::binary);
+        std::vector<char> buffer((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+        ret = detector.init(buffer.data(), buffer.size(), opts.detector);
+    } else if (opts.loadMode == "memory") {
+        // 内存中的模型来源，init 返回后即释放
+        MemoryModel model;
+        model.load(opts.modelPath);
+        ret = detector.init(model, opts.detector);
+    } else {
+        ret = detector.init(opts.modelPath, opts.detector);
+    }
+    double initMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+    if (ret != 0) {
+        fprintf(stderr, "init failed: %d\n", ret);
+        return 1;
+    }
+    double initRssMb = currentRssMb();
+
+    InputConfig input;
+    input.letterbox = opts.letterbox;
+    std::vector<FaceInfo> faces;
+    for (int i = 0; i < opts.warmup; ++i) {
+        for (const auto& img : images) detector.detect(img, &faces, nullptr, input);
+    }
+
+    std::vector<StageSamples> stages = {
+        {"resize",    &DetectProfile::resizeMs,    {}},
+        {"convert",   &DetectProfile::convertMs,   {}},
+        {"inference", &DetectProfile::inferenceMs, {}},
+        {"copy",      &DetectProfile::copyMs,      {}},
+        {"decode",    &DetectProfile::decodeMs,    {}},
+        {"nms",       &DetectProfile::nmsMs,       {}},
+        {"total",     &DetectProfile::totalMs,     {}},
+    };
+    size_t totalFaces = 0;
+    for (int i = 0; i < opts.iters; ++i) {
+        for (const auto& img : images) {
+            DetectProfile profile;
+            if (detector.detect(img, &faces, &profile, input) != 0) {
+                fprintf(stderr, "detect failed\n");
+                return 1;
+            }
+            totalFaces += faces.size();
+            for (auto& s : stages) s.samples.push_back(profile.*(s.field));
+        }
+    }
+
+    printf("model: %s\n", opts.modelPath.c_str());
+    printf("images: %zu, iters: %d, warmup: %d\n", images.size(), opts.iters, opts.warmup);
+    printf("load: %s, init: %.2f ms, RSS: %.1f MB before init, %.1f MB after init\n",
+           opts.loadMode.c_str(), initMs, loadedRssMb, initRssMb);
+    printf("threads: %d, precision: %d, input: %dx%d\n", opts.detector.numThreads,
+           opts.detector.precision, opts.detector.inputWidth, opts.detector.inputHeight);
+    printf("preprocess: %s, RSS: %.1f MB (peak %.1f MB)\n",
+           opts.preprocess == PreprocessMode::Fused ? "fused" : "resize",
+           currentRssMb(), peakRssMb());
+    printf("avg faces/image: %.2f\n",
+           static_cast<double>(totalFaces) / (images.size() * opts.iters));
+    printf("%-10s %10s %10s %10s %10s\n", "stage(ms)", "mean", "p50", "p95", "p99");
+    for (auto& s : stages) {
+        double sum = 0;
+        for (double v : s.samples) sum += v;
+        double mean = sum / s.samples.size();
+        printf("%-10s %10.3f %10.3f %10.3f %10.3f\n", s.name, mean,
+               percentile(&s.samples, 50), percentile(&s.samples, 95),
+               percentile(&s.samples, 99));
+    }
+
+    if (!opts.batchSizes.empty()) {
+        // 吞吐测试：循环取图凑满每个批次（各批大小的 session 已在 init 中创建）
+        printf("%-10s %12s %12s\n", "batch", "ms/batch", "images/sec");
+        std::vector<std::vector<FaceInfo>> batchFaces;
+        for (int batch : opts.batchSizes) {
+            std::vector<cv::Mat> batchImages(batch);
+            for (int b = 0; b < batch; ++b) batchImages[b] = images[b % images.size()];
+
+            for (int i = 0; i < std::max(opts.warmup, 1); ++i) {
+                detector.detectBatch(batchImages, &batchFaces);
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < opts.iters; ++i) {
+                if (detector.detectBatch(batchImages, &batchFaces) != 0) {
+                    fprintf(stderr, "detectBatch failed\n");
+                    return 1;
+                }
+            }
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count() / opts.iters;
+            printf("%-10d %12.3f %12.1f\n", batch, ms, batch * 1000.0 / ms);
+        }
+        printf("peak RSS after batching: %.1f MB\n", peakRssMb());
+    }
+
+    if (!opts.workerCounts.empty()) {
+        printf("%-10s %12s %10s\n", "workers", "images/sec", "speedup");
+        double baseline = 0;
+        for (int workers : opts.workerCounts) {
+            double rate = measureConcurrent(opts, images, workers);
+            if (rate < 0) {
+                fprintf(stderr, "init failed for %d workers\n", workers);
+                return 1;
+            }
+            if (baseline == 0) baseline = rate;
+            printf("%-10d %12.1f %9.2fx\n", workers, rate, rate / baseline);
+        }
+        printf("peak RSS after concurrency runs: %.1f MB\n", peakRssMb());
+    }
+
+    if (!opts.inputSizes.empty()) {
+        printf("%-10s %12s %12s %10s\n", "input", "first ms", "ms/image", "faces");
+        for (const auto& [w, h] : opts.inputSizes) {
+            InputConfig sized = input;
+            sized.width = w;
+            sized.height = h;
+            auto first = std::chrono::steady_clock::now();
+            if (detector.detect(images.front(), &faces, nullptr, sized) != 0) {
+                fprintf(stderr, "detect failed for input %dx%d\n", w, h);
+                return 1;
+            }
+            double firstMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - first).count();
+            size_t sizedFaces = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < opts.iters; ++i) {
+                for (const auto& img : images) {
+                    detector.detect(img, &faces, nullptr, sized);
+                    sizedFaces += faces.size();
+                }
+            }
+            const size_t count = images.size() * opts.iters;
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count() / count;
+            printf("%4dx%-5d %12.2f %12.3f %10.2f\n", w, h, firstMs, ms,
+                   static_cast<double>(sizedFaces) / count);
+        }
+    }
+
+    if (opts.regionExpand > 0) {
+        // 区域来自同一张图的整帧检测结果，模拟“上一帧”几乎不动的情况
+        facebook::react::RegionConfig regionConfig;
+        regionConfig.expand = opts.regionExpand;
+        std::vector<std::vector<FaceInfo>> previous(images.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+            detector.detect(images[i], &previous[i], nullptr, input);
+            // 创建批量 session
+            detector.detectInRegions(images[i], previous[i], &faces, regionConfig, nullptr, input);
+        }
+        double fullMs = 0;
+        double regionMs = 0;
+        size_t fullFaces = 0;
+        size_t regionFaces = 0;
+        for (int i = 0; i < opts.iters; ++i) {
+            for (size_t k = 0; k < images.size(); ++k) {
+                DetectProfile profile;
+                detector.detect(images[k], &faces, &profile, input);
+                fullMs += profile.totalMs;
+                fullFaces += faces.size();
+                if (detector.detectInRegions(images[k], previous[k], &faces, regionConfig,
+                                             &profile, input) != 0) {
+                    fprintf(stderr, "detectInRegions failed\n");
+                    return 1;
+                }
+                regionMs += profile.totalMs;
+                regionFaces += faces.size();
+            }
+        }
+        const size_t count = images.size() * opts.iters;
+        printf("%-10s %12s %10s\n", "regions", "ms/image", "faces");
+        printf("%-10s %12.3f %10.2f\n", "full", fullMs / count,
+               static_cast<double>(fullFaces) / count);
+        printf("x%-9.1f %12.3f %10.2f\n", opts.regionExpand, regionMs / count,
+               static_cast<double>(regionFaces) / count);
+    }
+
+    if (!opts.tileBatches.empty()) {
+        // 分块检测用多个 session 并行，单独 init 一个检测器
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        const int sessions = std::max(1, cores / std::max(1, opts.detector.numThreads));
+        NativeFaceDetector tiled;
+        tiled.setSessionCount(sessions);
+        tiled.setPreprocess(opts.preprocess, opts.filter);
+        tiled.setNms(nmsConfig);
+        // 模型缓冲在 init 后释放，各 tile 批大小的 session 要在 init 中创建
+        DetectorOptions tiledOptions = opts.detector;
+        tiledOptions.batchSizes.insert(tiledOptions.batchSizes.end(), opts.tileBatches.begin(),
+                                       opts.tileBatches.end());
+        if (tiled.init(opts.modelPath, tiledOptions) != 0) {
+            fprintf(stderr, "init failed for tiling\n");
+            return 1;
+        }
+        // 每个格子的宽度为模型输入宽度，缩小后的人脸在整图检测中只剩几个像素
+        const cv::Size cell(opts.detector.inputWidth, opts.detector.inputHeight);
+        GroupPhoto photo = makeGroupPhoto(tiled, images, 4000, 3000, cell);
+        printf("group photo: %dx%d, %zu faces, %d sessions\n", photo.image.cols, photo.image.rows,
+               photo.truth.size(), sessions);
+
+        auto run = [&](const char* name, auto&& detectOnce) {
+            detectOnce();
+            DetectProfile profile;
+            double ms = 0;
+            for (int i = 0; i < opts.iters; ++i) {
+                if (detectOnce(&profile) != 0) return false;
+                ms += profile.totalMs;
+            }
+            printf("%-14s %12.2f %10.2f %10zu %10.3f\n", name, ms / opts.iters,
+                   1000.0 * opts.iters / ms, faces.size(), recall(photo.truth, faces));
+            return true;
+        };
+        printf("%-14s %12s %10s %10s %10s\n", "mode", "ms/image", "images/s", "faces", "recall");
+        bool ok = run("single", [&](DetectProfile* profile = nullptr) {
+            return tiled.detect(photo.image, &faces, profile, input);
+        });
+        for (int batch : opts.tileBatches) {
+            for (bool coarse : {false, true}) {
+                facebook::react::TileConfig tileConfig;
+                tileConfig.batchSize = batch;
+                tileConfig.coarsePass = coarse;
+                char name[32];
+                snprintf(name, sizeof(name), "tiled b%d%s", batch, coarse ? "+c" : "");
+                ok = ok && run(name, [&](DetectProfile* profile = nullptr) {
+                    return tiled.detectTiled(photo.image, &faces, tileConfig, profile, input);
+                });
+            }
+        }
+        if (!ok) {
+            fprintf(stderr, "tiled detection failed\n");
+            return 1;
+        }
+        printf("tiles per image: %zu, peak RSS: %.1f MB\n",
+               tiled.tileRects(photo.image.cols, photo.image.rows,
+                               facebook::react::TileConfig(), input).size(),
+               peakRssMb());
+    }
+
+    if (opts.opsTopN > 0) {
+        // 回调计时有额外开销，单独跑一遍，不影响上面的阶段耗时
+        detector.setOpProfiling(true);
+        for (int i = 0; i < opts.iters; ++i) {
+            for (const cv::Mat& img : images) detector.detect(img, &faces, nullptr, input);
+        }
+        detector.setOpProfiling(false);
+        printf("%s", facebook::react::formatOpReport(detector.opReport(), opts.opsTopN).c_str());
+    }
+
+    if (!opts.cacheDir.empty()) {
+        // 与 NativeSampleModule::detectFaceLocked 相同的流程：键 → 查缓存 → 加载 + 检测 → 写入
+        const std::vector<std::string> paths = listImages(opts.imageDir);
+        const uint64_t configHash = ResultCache::hashBytes(opts.modelPath.data(), opts.modelPath.size());
+        ResultCache cache(paths.size() + 1);
+        cache.setDirectory(opts.cacheDir);
+        cache.clear();
+        auto elapsedUs = [](std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start).count();
+        };
+        double missUs = 0;
+        double memoryUs = 0;
+        double diskUs = 0;
+        for (const std::string& path : paths) {
+            uint64_t key = 0;
+            auto start = std::chrono::steady_clock::now();
+            if (!ResultCache::makeKey(path, configHash, false, &key) || cache.get(key, &faces)) {
+                fprintf(stderr, "unexpected cache state for %s\n", path.c_str());
+                return 1;
+            }
+            facebook::react::LoadedImage loaded;
+            if (facebook::react::loadImageForDetection(path, opts.detector.inputWidth,
+                                                       opts.detector.inputHeight, &loaded)) {
+                detector.detect(loaded.image, &faces, nullptr, input);
+            }
+            cache.put(key, faces);
+            missUs += elapsedUs(start);
+        }
+        for (int i = 0; i < opts.iters; ++i) {
+            for (const std::string& path : paths) {
+                uint64_t key = 0;
+                auto start = std::chrono::steady_clock::now();
+                ResultCache::makeKey(path, configHash, false, &key);
+                cache.get(key, &faces);
+                memoryUs += elapsedUs(start);
+            }
+        }
+        for (int i = 0; i < opts.iters; ++i) {
+            // 新实例的内存层为空，模拟应用重启后的首次查询
+            ResultCache cold;
+            cold.setDirectory(opts.cacheDir);
+            for (const std::string& path : paths) {
+                uint64_t key = 0;
+                auto start = std::chrono::steady_clock::now();
+                ResultCache::makeKey(path, configHash, false, &key);
+                cold.get(key, &faces);
+                diskUs += elapsedUs(start);
+            }
+        }
+        ResultCache::Stats stats = cache.stats();
+        printf("%-10s %12s\n", "cache", "us/query");
+        printf("%-10s %12.1f\n", "miss", missUs / paths.size());
+        printf("%-10s %12.1f\n", "memory", memoryUs / (paths.size() * opts.iters));
+        printf("%-10s %12.1f\n", "disk", diskUs / (paths.size() * opts.iters));
+        printf("memory hits: %llu, misses: %llu, disk entries: %zu\n",
+               static_cast<unsigned long long>(stats.memoryHits),
+               static_cast<unsigned long long>(stats.misses), stats.diskEntries);
+    }
+
+    if (!opts.scanDecodeThreads.empty()) {
+        // 与模块相同：检测器两个 session，init 时创建扫描默认批大小的 session，
+        // 解码按模型输入尺寸缩小
+        std::vector<std::string> library;
+        const std::vector<std::string> paths = listImages(opts.imageDir);
+        while (!paths.empty() && library.size() < 256) {
+            library.insert(library.end(), paths.begin(), paths.end());
+        }
+        auto scanDetector = std::make_shared<NativeFaceDetector>();
+        scanDetector->setSessionCount(2);
+        scanDetector->setPreprocess(opts.preprocess, opts.filter);
+        scanDetector->setNms(nmsConfig);
+        DetectorOptions scanOptions = opts.detector;
+        scanOptions.batchSizes.push_back(ScanConfig().batchSize);
+        if (scanDetector->init(opts.modelPath, scanOptions) != 0) {
+            fprintf(stderr, "init failed for scanning\n");
+            return 1;
+        }
+        const int minWidth = input.width > 0 ? input.width : opts.detector.inputWidth;
+        const int minHeight = input.height > 0 ? input.height : opts.detector.inputHeight;
+
+        // 串行：相当于从 JS 逐张调用 detectFace
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& path : library) {
+            facebook::react::LoadedImage loaded;
+            if (facebook::react::loadImageForDetection(path, minWidth, minHeight, &loaded)) {
+                scanDetector->detect(loaded.image, &faces, nullptr, input);
+            }
+        }
+        const double serialMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        printf("library: %zu images\n", library.size());
+        printf("%-12s %12s %10s %8s\n", "mode", "ms/image", "images/s", "speedup");
+        printf("%-12s %12.3f %10.1f %8.2f\n", "serial", serialMs / library.size(),
+               1000.0 * library.size() / serialMs, 1.0);
+
+        for (int threads : opts.scanDecodeThreads) {
+            ScanConfig scanConfig;
+            scanConfig.decodeThreads = threads;
+            scanConfig.input = input;
+            ScanPipeline scan(scanDetector, scanConfig);
+            size_t processed = 0;
+            start = std::chrono::steady_clock::now();
+            scan.start(library, [&](ScanProgress&& progress) { processed = progress.processed; });
+            scan.wait();
+            const double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+            if (processed != library.size()) {
+                fprintf(stderr, "scan processed %zu of %zu images\n", processed, library.size());
+                return 1;
+            }
+            char name[32];
+            snprintf(name, sizeof(name), "pipeline d%d", threads);
+            printf("%-12s %12.3f %10.1f %8.2f\n", name, ms / library.size(),
+                   1000.0 * library.size() / ms, serialMs / ms);
+        }
+    }
+
+    if (!opts.trackIntervals.empty()) {
+        // 视频模式需要共享的检测器，单独 init 一个（使用同一份模型和参数）
+        auto shared = std::make_shared<NativeFaceDetector>();
+        shared->setPreprocess(opts.preprocess, opts.filter);
+        shared->setNms(nmsConfig);
+        if (shared->init(opts.modelPath, opts.detector) != 0) {
+            fprintf(stderr, "init failed for tracking\n");
+            return 1;
+        }
+        std::vector<cv::Mat> clip = makeClip(images.front(), std::max(opts.iters, 60));
+        std::vector<std::vector<FaceInfo>> reference(clip.size());
+        for (size_t i = 0; i < clip.size(); ++i) shared->detect(clip[i], &reference[i], nullptr, input);
+
+        printf("tracking clip: %zu frames of %dx%d\n", clip.size(), clip[0].cols, clip[0].rows);
+        printf("%-10s %12s %10s %10s %8s\n", "interval", "ms/frame", "detects", "IoU", "ids");
+        for (int interval : opts.trackIntervals) {
+            TrackerOptions trackerOptions;
+            trackerOptions.detectInterval = interval;
+            trackerOptions.input = input;
+            TrackResult result;
+            if (!measureTracking(shared, clip, reference, trackerOptions, &result)) {
+                fprintf(stderr, "tracking failed for interval %d\n", interval);
+                return 1;
+            }
+            printf("%-10d %12.3f %10llu %10.3f %8zu\n", interval, result.msPerFrame,
+                   static_cast<unsigned long long>(result.detections), result.meanIoU, result.ids);
+        }
+    }
+
+    if (!opts.switchBudgetsMb.empty()) {
+        printf("%-10s %12s %8s %10s %12s\n", "budget MB", "ms/switch", "loads", "evictions",
+               "resident MB");
+        for (int budget : opts.switchBudgetsMb) {
+            ModelRegistry::Stats stats;
+            double ms = measureModelSwitch(opts, images, budget, &stats);
+            if (ms < 0) {
+                fprintf(stderr, "model switch failed\n");
+                return 1;
+            }
+            printf("%-10d %12.3f %8llu %10llu %12.2f\n", budget, ms,
+                   static_cast<unsigned long long>(stats.loads),
+                   static_cast<unsigned long long>(stats.evictions),
+                   stats.residentBytes / 1048576.0);
+        }
+    }
+    return 0;
+}
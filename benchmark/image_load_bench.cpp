@@ -0,0 +1,173 @@
+// 图像加载基准测试：全尺寸 imread 与 loadImageForDetection（缩小解码）
+//
+// 用法: image_load_bench [--iters N] [--input WxH] [--sizes WxH,...] [image.jpg ...]
+//
+// 不给图片时按常见手机照片尺寸（默认 1920x1080, 3264x2448, 4032x3024, 8000x6000）
+// 合成 JPEG（质量 90）写入临时目录。每个图片 / 模式在单独的子进程中运行，
+// 输出平均解码耗时、解码结果尺寸和子进程的峰值 RSS（包含进程本身的基线）。
+
+#include "ImageLoader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using facebook::react::LoadedImage;
+using facebook::react::loadImageForDetection;
+using facebook::react::readJpegSize;
+
+namespace {
+
+struct Options {
+    int iters = 10;
+    int inputWidth = 320;
+    int inputHeight = 240;
+    std::vector<std::pair<int, int>> sizes = {{1920, 1080}, {3264, 2448}, {4032, 3024}, {8000, 6000}};
+    std::vector<std::string> images;
+};
+
+bool parseSizeList(const char* list, std::vector<std::pair<int, int>>* sizes) {
+    sizes->clear();
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int w = 0, h = 0;
+        if (sscanf(item.c_str(), "%dx%d", &w, &h) != 2 || w < 2 || h < 2) return false;
+        sizes->emplace_back(w, h);
+    }
+    return !sizes->empty();
+}
+
+bool parseArgs(int argc, char** argv, Options* opts) {
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--iters") && i + 1 < argc) {
+            opts->iters = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--input") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &opts->inputWidth, &opts->inputHeight) != 2) {
+                return false;
+            }
+        } else if (!strcmp(argv[i], "--sizes") && i + 1 < argc) {
+            if (!parseSizeList(argv[++i], &opts->sizes)) return false;
+        } else if (argv[i][0] == '-') {
+            return false;
+        } else {
+            opts->images.push_back(argv[i]);
+        }
+    }
+    return opts->iters > 0 && opts->inputWidth > 0 && opts->inputHeight > 0;
+}
+
+// 合成一张带纹理的照片：平滑渐变 + 噪声，JPEG 压缩率与真实照片接近
+std::string makeJpeg(const std::string& dir, int width, int height) {
+    cv::Mat image(height, width, CV_8UC3);
+    cv::Mat noise(height / 8 + 1, width / 8 + 1, CV_8UC3);
+    cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::resize(noise, image, image.size(), 0, 0, cv::INTER_CUBIC);
+    cv::Mat fine(height, width, CV_8UC3);
+    cv::randn(fine, cv::Scalar::all(0), cv::Scalar::all(12));
+    image += fine;
+    std::string path = dir + "/photo_" + std::to_string(width) + "x" + std::to_string(height) + ".jpg";
+    cv::imwrite(path, image, {cv::IMWRITE_JPEG_QUALITY, 90});
+    return path;
+}
+
+struct Result {
+    double ms = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// 在子进程中解码 iters 次，返回平均耗时和解码尺寸；peakMb 为子进程峰值 RSS
+bool measure(const Options& opts, const std::string& path, bool reduced, Result* result,
+             double* peakMb) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        close(fds[0]);
+        Result r;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < opts.iters; ++i) {
+            cv::Mat image;
+            if (reduced) {
+                LoadedImage loaded;
+                if (!loadImageForDetection(path, opts.inputWidth, opts.inputHeight, &loaded)) _exit(1);
+                image = loaded.image;
+            } else {
+                image = cv::imread(path);
+            }
+            if (image.empty()) _exit(1);
+            r.width = image.cols;
+            r.height = image.rows;
+        }
+        r.ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count() / opts.iters;
+        ssize_t written = write(fds[1], &r, sizeof(r));
+        _exit(written == sizeof(r) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], result, sizeof(*result));
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return false;
+    }
+    *peakMb = usage.ru_maxrss / 1024.0;  // Linux 上单位为 KB
+    return got == sizeof(*result);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, &opts)) {
+        fprintf(stderr, "usage: %s [--iters N] [--input WxH] [--sizes WxH,...] [image.jpg ...]\n",
+                argv[0]);
+        return 1;
+    }
+
+    std::string tempDir;
+    if (opts.images.empty()) {
+        tempDir = (std::filesystem::temp_directory_path() / "image_load_bench").string();
+        std::filesystem::create_directories(tempDir);
+        for (const auto& [w, h] : opts.sizes) opts.images.push_back(makeJpeg(tempDir, w, h));
+    }
+
+    printf("target input: %dx%d, iters: %d\n", opts.inputWidth, opts.inputHeight, opts.iters);
+    printf("%-12s %-9s %12s %12s %10s\n", "image", "mode", "decoded", "ms/image", "peak MB");
+    for (const std::string& path : opts.images) {
+        int width = 0;
+        int height = 0;
+        char name[32];
+        if (readJpegSize(path, &width, &height)) {
+            snprintf(name, sizeof(name), "%dx%d", width, height);
+        } else {
+            snprintf(name, sizeof(name), "(not jpeg)");
+        }
+        for (bool reduced : {false, true}) {
+            Result result;
+            double peakMb = 0;
+            if (!measure(opts, path, reduced, &result, &peakMb)) {
+                fprintf(stderr, "failed to decode %s\n", path.c_str());
+                return 1;
+            }
+            char decoded[32];
+            snprintf(decoded, sizeof(decoded), "%dx%d", result.width, result.height);
+            printf("%-12s %-9s %12s %12.2f %10.1f\n", name, reduced ? "reduced" : "full",
+                   decoded, result.ms, peakMb);
+        }
+    }
+
+    if (!tempDir.empty()) std::filesystem::remove_all(tempDir);
+    return 0;
+}
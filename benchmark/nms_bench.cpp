@@ -0,0 +1,172 @@
+// NMS 微基准
+//
+// 用法: nms_bench [--iou T]
+//
+// 在 10 / 100 / 1k / 10k 个候选框上比较原 NativeFaceDetector::nms 与 NmsEngine 各模式的耗时，
+// 并校验 Greedy 模式的输出与原实现一致。候选框模拟拥挤场景：每 8 个框围绕同一张脸抖动。
+
+#include "FaceNms.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace facebook::react;
+
+namespace {
+
+struct Random {
+    uint32_t state = 2024;
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+// wide: 另加一个覆盖整张图的低分框（近景大脸 / 误检），检验大框是否拖慢所有查询
+std::vector<FaceInfo> makeCandidates(int n, bool wide, Random* rng) {
+    const float imageW = 4000.0f, imageH = 3000.0f;
+    int numFaces = std::max(1, n / 8);
+    std::vector<FaceInfo> faces(numFaces);
+    for (auto& f : faces) {
+        f.width = f.height = 20.0f + 180.0f * rng->next();
+        f.x = (imageW - f.width) * rng->next();
+        f.y = (imageH - f.height) * rng->next();
+    }
+    std::vector<FaceInfo> candidates(n);
+    for (int i = 0; i < n; ++i) {
+        const FaceInfo& f = faces[i % numFaces];
+        FaceInfo& c = candidates[i];
+        float jitter = 0.1f * f.width;
+        c.x = f.x + jitter * (2 * rng->next() - 1);
+        c.y = f.y + jitter * (2 * rng->next() - 1);
+        c.width = c.height = f.width * (0.9f + 0.2f * rng->next());
+        c.score = 0.95f + 0.05f * rng->next();
+    }
+    if (wide) {
+        FaceInfo& c = candidates.back();
+        c.x = 0.0f;
+        c.y = 0.0f;
+        c.width = imageW;
+        c.height = imageH;
+        c.score = 0.5f;
+    }
+    return candidates;
+}
+
+// 原 NativeFaceDetector::nms 实现
+void nmsLegacy(const std::vector<FaceInfo>& inputs, std::vector<FaceInfo>* result,
+               const float& threshold) {
+    result->clear();
+    if (inputs.size() == 0) return;
+
+    std::vector<FaceInfo> inputsTmp = inputs;
+    std::sort(inputsTmp.begin(), inputsTmp.end(),
+        [](const FaceInfo& a, const FaceInfo& b) { return a.score > b.score; });
+
+    std::vector<int> indexes(inputsTmp.size());
+    for (size_t i = 0; i < indexes.size(); i++) indexes[i] = i;
+
+    while (indexes.size() > 0) {
+        int indexGood = indexes[0];
+        std::vector<int> indexesTmp = indexes;
+        indexes.clear();
+        std::vector<int> indexesNms;
+        indexesNms.push_back(indexGood);
+
+        for (size_t i = 1; i < indexesTmp.size(); ++i) {
+            int indexTmp = indexesTmp[i];
+            float x1 = std::max(inputsTmp[indexGood].x, inputsTmp[indexTmp].x);
+            float y1 = std::max(inputsTmp[indexGood].y, inputsTmp[indexTmp].y);
+            float x2 = std::min(inputsTmp[indexGood].x + inputsTmp[indexGood].width,
+                                inputsTmp[indexTmp].x + inputsTmp[indexTmp].width);
+            float y2 = std::min(inputsTmp[indexGood].y + inputsTmp[indexGood].height,
+                                inputsTmp[indexTmp].y + inputsTmp[indexTmp].height);
+            float w = std::max(0.0f, x2 - x1);
+            float h = std::max(0.0f, y2 - y1);
+            float interArea = w * h;
+            float area1 = inputsTmp[indexGood].width * inputsTmp[indexGood].height;
+            float area2 = inputsTmp[indexTmp].width * inputsTmp[indexTmp].height;
+            float iou = interArea / (area1 + area2 - interArea);
+            if (iou <= threshold) {
+                indexes.push_back(indexTmp);
+            } else {
+                indexesNms.push_back(indexTmp);
+            }
+        }
+        result->push_back(inputsTmp[indexGood]);
+    }
+}
+
+template <typename Fn>
+double timeUs(int iters, Fn&& fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; ++i) fn();
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - t0).count() / iters;
+}
+
+bool sameFaces(const std::vector<FaceInfo>& a, const std::vector<FaceInfo>& b) {
+    return a.size() == b.size() &&
+           (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(FaceInfo)) == 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    float iou = 0.3f;
+    bool wide = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--iou") && i + 1 < argc) {
+            iou = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--wide")) {
+            wide = true;
+        } else {
+            fprintf(stderr, "usage: %s [--iou T] [--wide]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct Mode {
+        const char* name;
+        NmsMode mode;
+    };
+    const Mode modes[] = {
+        {"greedy", NmsMode::Greedy},
+        {"soft-lin", NmsMode::SoftLinear},
+        {"soft-gau", NmsMode::SoftGaussian},
+        {"weighted", NmsMode::Weighted},
+    };
+
+    bool allMatch = true;
+    Random rng;
+    NmsEngine engine;
+    std::vector<FaceInfo> legacyOut, engineOut;
+
+    printf("%-8s %-10s %12s %8s\n", "n", "impl", "us/call", "kept");
+    for (int n : {10, 100, 1000, 10000}) {
+        std::vector<FaceInfo> candidates = makeCandidates(n, wide, &rng);
+        int iters = std::max(3, 200000 / n);
+        if (n >= 10000) iters = 3;  // 原实现在 10k 时是 O(n^2)
+
+        double legacyUs = timeUs(iters, [&] { nmsLegacy(candidates, &legacyOut, iou); });
+        printf("%-8d %-10s %12.2f %8zu\n", n, "legacy", legacyUs, legacyOut.size());
+
+        for (const Mode& m : modes) {
+            NmsConfig config;
+            config.mode = m.mode;
+            config.iouThreshold = iou;
+            double us = timeUs(iters, [&] { engine.run(candidates, config, &engineOut); });
+            printf("%-8d %-10s %12.2f %8zu\n", n, m.name, us, engineOut.size());
+            if (m.mode == NmsMode::Greedy && !sameFaces(legacyOut, engineOut)) {
+                printf("  greedy output differs from legacy!\n");
+                allMatch = false;
+            }
+        }
+    }
+    printf("greedy == legacy: %s\n", allMatch ? "yes" : "NO");
+    return allMatch ? 0 : 1;
+}
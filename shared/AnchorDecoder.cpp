@@ -0,0 +1,395 @@
+#include "AnchorDecoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// SIMD 与标量路径必须逐位一致：禁止编译器把 a * b + c 融合成 FMA
+// （GCC 不识别该 pragma，宿主机构建通过 -ffp-contract=off 保证）
+#if defined(__clang__)
+  #pragma STDC FP_CONTRACT OFF
+#endif
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define FACE_DECODER_AVX2 1
+  #define FACE_DECODER_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+  #define FACE_DECODER_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define FACE_DECODER_NEON 1
+#endif
+
+namespace facebook::react {
+
+namespace {
+
+// fastExp 常量：exp(x) = 2^n * 2^f，n = round(x * log2(e))，f ∈ [-0.5, 0.5]
+// 2^f 采用 Cephes exp2f 的多项式（相对误差约 2e-7）
+constexpr float kExpLo = -87.0f;
+constexpr float kExpHi = 88.0f;
+constexpr float kLog2e = 1.44269504f;
+constexpr float kExpC1 = 6.931472028550421e-1f;
+constexpr float kExpC2 = 2.402264791363012e-1f;
+constexpr float kExpC3 = 5.550332471162809e-2f;
+constexpr float kExpC4 = 9.618437357674640e-3f;
+constexpr float kExpC5 = 1.339887440266574e-3f;
+constexpr float kExpC6 = 1.535336188319500e-4f;
+
+// fastExp 的内联实现：n 用截断再修正求 floor，与 SIMD 版本的步骤相同（避免 std::floor
+// 在没有 SSE4.1 / ARMv8 舍入指令的目标上变成分支或库调用）
+inline float fastExpInline(float x) {
+    x = std::min(std::max(x, kExpLo), kExpHi);
+    float t = x * kLog2e;
+    float th = t + 0.5f;
+    int32_t n = static_cast<int32_t>(th);
+    n -= static_cast<float>(n) > th ? 1 : 0;
+    float f = t - static_cast<float>(n);
+    float p = kExpC6;
+    p = p * f + kExpC5;
+    p = p * f + kExpC4;
+    p = p * f + kExpC3;
+    p = p * f + kExpC2;
+    p = p * f + kExpC1;
+    p = p * f + 1.0f;
+    int32_t e = (n + 127) << 23;
+    float scale;
+    memcpy(&scale, &e, sizeof(scale));
+    return p * scale;
+}
+
+inline float clip(float v, float hi) {
+    return v < 0 ? 0 : (v > hi ? hi : v);
+}
+
+// 把归一化的中心点/宽高转换为原图像素坐标下的正方形人脸框
+inline void emitFace(float centerX, float centerY, float centerW, float centerH,
+                     float score, int width, int height, std::vector<FaceInfo>* faces) {
+    int faceX = static_cast<int>(clip(centerX - centerW / 2.0f, 1.0f) * width);
+    int faceY = static_cast<int>(clip(centerY - centerH / 2.0f, 1.0f) * height);
+    int faceW = static_cast<int>(clip(centerW, 1.0f) * width);
+    int faceH = static_cast<int>(clip(centerH, 1.0f) * height);
+
+    // 转换为正方形
+    int maxSide = std::max(faceW, faceH);
+    FaceInfo faceInfo;
+    faceInfo.x = faceX + 0.5f * faceW - 0.5f * maxSide;
+    faceInfo.y = faceY + 0.5f * faceH - 0.5f * maxSide;
+    faceInfo.width = maxSide;
+    faceInfo.height = maxSide;
+    faceInfo.x = clip(faceInfo.x, static_cast<float>(width - maxSide));
+    faceInfo.y = clip(faceInfo.y, static_cast<float>(height - maxSide));
+    faceInfo.score = clip(score, 1.0f);
+    faces->push_back(faceInfo);
+}
+
+// 按 4 位掩码追加候选下标
+inline void appendMask(unsigned mask, int base, std::vector<int>* indices) {
+    while (mask) {
+        int bit = __builtin_ctz(mask);
+        indices->push_back(base + bit);
+        mask &= mask - 1;
+    }
+}
+
+#if defined(FACE_DECODER_SSE2)
+
+inline __m128 fastExp4(__m128 x) {
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(kExpLo)), _mm_set1_ps(kExpHi));
+    __m128 t = _mm_mul_ps(x, _mm_set1_ps(kLog2e));
+    // n = floor(t + 0.5)：截断后对负数修正
+    __m128 th = _mm_add_ps(t, _mm_set1_ps(0.5f));
+    __m128 tf = _mm_cvtepi32_ps(_mm_cvttps_epi32(th));
+    tf = _mm_sub_ps(tf, _mm_and_ps(_mm_cmpgt_ps(tf, th), _mm_set1_ps(1.0f)));
+    __m128 f = _mm_sub_ps(t, tf);
+    __m128 p = _mm_set1_ps(kExpC6);
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC5));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC4));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC3));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC2));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC1));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+    __m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(tf), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(p, _mm_castsi128_ps(e));
+}
+
+#elif defined(FACE_DECODER_NEON)
+
+inline float32x4_t fastExp4(float32x4_t x) {
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(kExpLo)), vdupq_n_f32(kExpHi));
+    float32x4_t t = vmulq_f32(x, vdupq_n_f32(kLog2e));
+    // n = floor(t + 0.5)：截断后对负数修正
+    float32x4_t th = vaddq_f32(t, vdupq_n_f32(0.5f));
+    float32x4_t tf = vcvtq_f32_s32(vcvtq_s32_f32(th));
+    uint32x4_t gt = vcgtq_f32(tf, th);
+    tf = vsubq_f32(tf, vreinterpretq_f32_u32(vandq_u32(gt, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))));
+    float32x4_t f = vsubq_f32(t, tf);
+    float32x4_t p = vdupq_n_f32(kExpC6);
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(kExpC5));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(kExpC4));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(kExpC3));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(kExpC2));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(kExpC1));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(1.0f));
+    int32x4_t e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(tf), vdupq_n_s32(127)), 23);
+    return vmulq_f32(p, vreinterpretq_f32_s32(e));
+}
+
+// 比较结果转 4 位掩码
+inline unsigned moveMask(uint32x4_t mask) {
+    static const uint32_t kBits[4] = {1, 2, 4, 8};
+    uint32x4_t bits = vandq_u32(mask, vld1q_u32(kBits));
+    uint32x2_t sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    sum = vpadd_u32(sum, sum);
+    return vget_lane_u32(sum, 0);
+}
+
+#endif
+
+// 运行时方差（通用路径）
+struct RuntimeVariance {
+    float center;
+    float size;
+};
+
+// 编译期方差（特化路径）
+template <typename Model>
+struct ModelVariance {
+    static constexpr float center = Model::kCenterVariance;
+    static constexpr float size = Model::kSizeVariance;
+};
+
+// Anchors 为 AnchorTable 或 FixedAnchorTable，两者的 cx/cy/w/h 都支持下标访问
+template <typename Anchors, typename Variance>
+void decodeRangeScalar(const float* scores, const float* boxes, const Anchors& anchors,
+                       const int* indices, size_t count, Variance variance,
+                       int imageWidth, int imageHeight, std::vector<FaceInfo>* faces) {
+    const float cv = variance.center;
+    const float sv = variance.size;
+    for (size_t k = 0; k < count; ++k) {
+        int i = indices[k];
+        const float* box = boxes + 4 * i;
+        float centerX = box[0] * cv * anchors.w[i] + anchors.cx[i];
+        float centerY = box[1] * cv * anchors.h[i] + anchors.cy[i];
+        float centerW = fastExpInline(box[2] * sv) * anchors.w[i];
+        float centerH = fastExpInline(box[3] * sv) * anchors.h[i];
+        emitFace(centerX, centerY, centerW, centerH, scores[2 * i + 1],
+                 imageWidth, imageHeight, faces);
+    }
+}
+
+// 标量筛选：每 4 个 anchor 的比较结果合成掩码，只在有候选时分支（候选比例很低，
+// 逐个判断时几乎每个候选都会分支预测失败），与 SIMD 路径的结构相同
+inline void selectRangeScalar(const float* scores, int begin, int numAnchors, float threshold,
+                              std::vector<int>* indices) {
+    int i = begin;
+    for (; i + 4 <= numAnchors; i += 4) {
+        const float* face = scores + 2 * i + 1;
+        unsigned mask = static_cast<unsigned>(face[0] > threshold) |
+                        static_cast<unsigned>(face[2] > threshold) << 1 |
+                        static_cast<unsigned>(face[4] > threshold) << 2 |
+                        static_cast<unsigned>(face[6] > threshold) << 3;
+        if (mask) {
+            appendMask(mask, i, indices);
+        }
+    }
+    for (; i < numAnchors; ++i) {
+        if (scores[2 * i + 1] > threshold) {
+            indices->push_back(i);
+        }
+    }
+}
+
+inline void selectRange(const float* scores, int numAnchors, float threshold,
+                        std::vector<int>* indices) {
+    indices->clear();
+    int i = 0;
+#if defined(FACE_DECODER_AVX2)
+    const __m256 thr8 = _mm256_set1_ps(threshold);
+    for (; i + 8 <= numAnchors; i += 8) {
+        __m256 a = _mm256_loadu_ps(scores + 2 * i);
+        __m256 b = _mm256_loadu_ps(scores + 2 * i + 8);
+        // 取出奇数位（face 分数），shuffle 在 128 位内进行，需要再排列一次
+        __m256 face = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        face = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(face),
+                                                      _MM_SHUFFLE(3, 1, 2, 0)));
+        unsigned mask = _mm256_movemask_ps(_mm256_cmp_ps(face, thr8, _CMP_GT_OQ));
+        appendMask(mask, i, indices);
+    }
+#endif
+#if defined(FACE_DECODER_SSE2)
+    const __m128 thr4 = _mm_set1_ps(threshold);
+    for (; i + 4 <= numAnchors; i += 4) {
+        __m128 a = _mm_loadu_ps(scores + 2 * i);
+        __m128 b = _mm_loadu_ps(scores + 2 * i + 4);
+        __m128 face = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        appendMask(_mm_movemask_ps(_mm_cmpgt_ps(face, thr4)), i, indices);
+    }
+#elif defined(FACE_DECODER_NEON)
+    const float32x4_t thr4 = vdupq_n_f32(threshold);
+    for (; i + 4 <= numAnchors; i += 4) {
+        float32x4x2_t pair = vld2q_f32(scores + 2 * i);
+        appendMask(moveMask(vcgtq_f32(pair.val[1], thr4)), i, indices);
+    }
+#endif
+    selectRangeScalar(scores, i, numAnchors, threshold, indices);
+}
+
+template <typename Anchors, typename Variance>
+void decodeRange(const float* scores, const float* boxes, const Anchors& anchors,
+                 const std::vector<int>& indices, Variance variance,
+                 int imageWidth, int imageHeight, std::vector<FaceInfo>* faces) {
+#if defined(FACE_DECODER_SSE2) || defined(FACE_DECODER_NEON)
+    const size_t count = indices.size();
+    size_t k = 0;
+    // 每次解码 4 个候选：先 gather 到 SoA 小数组，再做向量运算
+    alignas(16) float dx[4], dy[4], dw[4], dh[4];
+    alignas(16) float acx[4], acy[4], aw[4], ah[4];
+    alignas(16) float outX[4], outY[4], outW[4], outH[4];
+    for (; k + 4 <= count; k += 4) {
+        for (int j = 0; j < 4; ++j) {
+            int i = indices[k + j];
+            const float* box = boxes + 4 * i;
+            dx[j] = box[0];
+            dy[j] = box[1];
+            dw[j] = box[2];
+            dh[j] = box[3];
+            acx[j] = anchors.cx[i];
+            acy[j] = anchors.cy[i];
+            aw[j] = anchors.w[i];
+            ah[j] = anchors.h[i];
+        }
+#if defined(FACE_DECODER_SSE2)
+        const __m128 cv = _mm_set1_ps(variance.center);
+        const __m128 sv = _mm_set1_ps(variance.size);
+        __m128 vw = _mm_load_ps(aw);
+        __m128 vh = _mm_load_ps(ah);
+        _mm_store_ps(outX, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_load_ps(dx), cv), vw), _mm_load_ps(acx)));
+        _mm_store_ps(outY, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_load_ps(dy), cv), vh), _mm_load_ps(acy)));
+        _mm_store_ps(outW, _mm_mul_ps(fastExp4(_mm_mul_ps(_mm_load_ps(dw), sv)), vw));
+        _mm_store_ps(outH, _mm_mul_ps(fastExp4(_mm_mul_ps(_mm_load_ps(dh), sv)), vh));
+#else
+        const float32x4_t cv = vdupq_n_f32(variance.center);
+        const float32x4_t sv = vdupq_n_f32(variance.size);
+        float32x4_t vw = vld1q_f32(aw);
+        float32x4_t vh = vld1q_f32(ah);
+        vst1q_f32(outX, vaddq_f32(vmulq_f32(vmulq_f32(vld1q_f32(dx), cv), vw), vld1q_f32(acx)));
+        vst1q_f32(outY, vaddq_f32(vmulq_f32(vmulq_f32(vld1q_f32(dy), cv), vh), vld1q_f32(acy)));
+        vst1q_f32(outW, vmulq_f32(fastExp4(vmulq_f32(vld1q_f32(dw), sv)), vw));
+        vst1q_f32(outH, vmulq_f32(fastExp4(vmulq_f32(vld1q_f32(dh), sv)), vh));
+#endif
+        for (int j = 0; j < 4; ++j) {
+            emitFace(outX[j], outY[j], outW[j], outH[j], scores[2 * indices[k + j] + 1],
+                     imageWidth, imageHeight, faces);
+        }
+    }
+    decodeRangeScalar(scores, boxes, anchors, indices.data() + k, count - k, variance,
+                      imageWidth, imageHeight, faces);
+#else
+    decodeRangeScalar(scores, boxes, anchors, indices.data(), indices.size(), variance,
+                      imageWidth, imageHeight, faces);
+#endif
+}
+
+} // namespace
+
+void generateAnchors(int width, int height,
+                     const std::vector<std::vector<float>>& minBoxes,
+                     const std::vector<float>& strides,
+                     AnchorTable* anchors) {
+    anchors->clear();
+    int numStrides = static_cast<int>(strides.size());
+
+    for (int i = 0; i < numStrides; ++i) {
+        auto stride = strides[i];
+
+        int numX = ceil(width / stride);
+        int numY = ceil(height / stride);
+
+        for (int y = 0; y < numY; ++y) {
+            for (int x = 0; x < numX; ++x) {
+                float centerX = (x + 0.5f) * stride / width;
+                float centerY = (y + 0.5f) * stride / height;
+
+                for (auto minBox : minBoxes[i]) {
+                    float centerW = minBox / width;
+                    float centerH = minBox / height;
+                    anchors->push(clip(centerX, 1.0f), clip(centerY, 1.0f),
+                                  clip(centerW, 1.0f), clip(centerH, 1.0f));
+                }
+            }
+        }
+    }
+}
+
+float fastExp(float x) {
+    return fastExpInline(x);
+}
+
+void selectCandidatesScalar(const float* scores, int numAnchors, float threshold,
+                            std::vector<int>* indices) {
+    indices->clear();
+    selectRangeScalar(scores, 0, numAnchors, threshold, indices);
+}
+
+void selectCandidates(const float* scores, int numAnchors, float threshold,
+                      std::vector<int>* indices) {
+    selectRange(scores, numAnchors, threshold, indices);
+}
+
+void decodeCandidatesScalar(const float* scores, const float* boxes,
+                            const AnchorTable& anchors, const std::vector<int>& indices,
+                            const DecodeParams& params, std::vector<FaceInfo>* faces) {
+    decodeRangeScalar(scores, boxes, anchors, indices.data(), indices.size(),
+                      RuntimeVariance{params.centerVariance, params.sizeVariance},
+                      params.imageWidth, params.imageHeight, faces);
+}
+
+void decodeCandidates(const float* scores, const float* boxes,
+                      const AnchorTable& anchors, const std::vector<int>& indices,
+                      const DecodeParams& params, std::vector<FaceInfo>* faces) {
+    decodeRange(scores, boxes, anchors, indices,
+                RuntimeVariance{params.centerVariance, params.sizeVariance},
+                params.imageWidth, params.imageHeight, faces);
+}
+
+template <typename Model>
+const FixedAnchorTable<ultraFaceAnchorCount<Model>()>& FixedDecoder<Model>::anchors() {
+    // 编译期生成，放在只读数据段
+    static constexpr FixedAnchorTable<ultraFaceAnchorCount<Model>()> kAnchors =
+        makeFixedAnchors<Model>();
+    return kAnchors;
+}
+
+template <typename Model>
+void FixedDecoder<Model>::select(const float* scores, float threshold, std::vector<int>* indices) {
+    // anchor 数为常量：循环次数已知，4 的倍数时没有尾部循环
+    selectRange(scores, kNumAnchors, threshold, indices);
+}
+
+template <typename Model>
+void FixedDecoder<Model>::decode(const float* scores, const float* boxes,
+                                 const std::vector<int>& indices, const DecodeParams& params,
+                                 std::vector<FaceInfo>* faces) {
+    decodeRange(scores, boxes, anchors(), indices, ModelVariance<Model>(),
+                params.imageWidth, params.imageHeight, faces);
+}
+
+template struct FixedDecoder<UltraFaceRfb320>;
+
+const char* decoderSimdName() {
+#if defined(FACE_DECODER_AVX2)
+    return "avx2";
+#elif defined(FACE_DECODER_SSE2)
+    return "sse2";
+#elif defined(FACE_DECODER_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace facebook::react
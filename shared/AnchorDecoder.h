@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "FaceInfo.h"
+#include "UltraFaceModel.h"
+
+namespace facebook::react {
+
+// anchor 表（SoA 布局），所有值都已归一化到 [0, 1]
+struct AnchorTable {
+    std::vector<float> cx;
+    std::vector<float> cy;
+    std::vector<float> w;
+    std::vector<float> h;
+
+    size_t size() const { return cx.size(); }
+
+    void clear() {
+        cx.clear();
+        cy.clear();
+        w.clear();
+        h.clear();
+    }
+
+    void push(float centerX, float centerY, float width, float height) {
+        cx.push_back(centerX);
+        cy.push_back(centerY);
+        w.push_back(width);
+        h.push_back(height);
+    }
+};
+
+// 解码参数
+struct DecodeParams {
+    float scoreThreshold = 0.95f;
+    float centerVariance = 0.1f;
+    float sizeVariance = 0.2f;
+    int imageWidth = 0;   // 原图宽度，输出坐标以原图像素为单位
+    int imageHeight = 0;  // 原图高度
+};
+
+// 生成 UltraFace anchors
+void generateAnchors(int width, int height,
+                     const std::vector<std::vector<float>>& minBoxes,
+                     const std::vector<float>& strides,
+                     AnchorTable* anchors);
+
+// 快速 exp（多项式近似，相对误差约 3e-7），SIMD 版本与之逐位一致
+float fastExp(float x);
+
+// 筛选人脸分数 > threshold 的 anchor 下标
+// scores 为模型输出的 [bg, face] 交错数组，长度 2 * numAnchors
+void selectCandidates(const float* scores, int numAnchors, float threshold,
+                      std::vector<int>* indices);
+
+// 解码候选 anchor 的边界框并追加到 faces
+// boxes 为模型输出的 [dx, dy, dw, dh] 交错数组
+void decodeCandidates(const float* scores, const float* boxes,
+                      const AnchorTable& anchors, const std::vector<int>& indices,
+                      const DecodeParams& params, std::vector<FaceInfo>* faces);
+
+// 标量实现，与 SIMD 实现结果完全一致（用于无 SIMD 平台和一致性校验）
+void selectCandidatesScalar(const float* scores, int numAnchors, float threshold,
+                            std::vector<int>* indices);
+void decodeCandidatesScalar(const float* scores, const float* boxes,
+                            const AnchorTable& anchors, const std::vector<int>& indices,
+                            const DecodeParams& params, std::vector<FaceInfo>* faces);
+
+// 按模型描述在编译期特化的解码器：anchor 表在编译期生成（只读数据段，无需 init 时分配），
+// anchor 数和方差都是常量。输出与通用路径（同尺寸的 generateAnchors + decodeCandidates）
+// 逐位一致。只为 AnchorDecoder.cpp 中显式实例化的模型提供（当前为 UltraFaceRfb320）。
+template <typename Model>
+struct FixedDecoder {
+    static constexpr int kInputWidth = Model::kInputWidth;
+    static constexpr int kInputHeight = Model::kInputHeight;
+    static constexpr int kNumAnchors = static_cast<int>(ultraFaceAnchorCount<Model>());
+
+    static const FixedAnchorTable<ultraFaceAnchorCount<Model>()>& anchors();
+
+    // 同 selectCandidates，scores 长度为 2 * kNumAnchors
+    static void select(const float* scores, float threshold, std::vector<int>* indices);
+
+    // 同 decodeCandidates，方差取 Model 的常量（忽略 params 中的方差）
+    static void decode(const float* scores, const float* boxes, const std::vector<int>& indices,
+                       const DecodeParams& params, std::vector<FaceInfo>* faces);
+};
+
+// 当前编译使用的 SIMD 指令集（"avx2" / "sse2" / "neon" / "scalar"）
+const char* decoderSimdName();
+
+} // namespace facebook::react
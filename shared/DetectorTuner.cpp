@@ -0,0 +1,250 @@
+#include "DetectorTuner.h"
+#include "Log.h"
+
+#if defined(__APPLE__)
+  #include <sys/sysctl.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <thread>
+
+#define TAG "DetectorTuner"
+
+namespace facebook::react {
+
+namespace {
+
+// FNV-1a 64 位哈希
+uint64_t fnv1a(const char* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// CPU 特征：核数 + 机型（iOS）或 /proc/cpuinfo 中描述 CPU 型号的行（Android / Linux）
+uint64_t cpuSignature() {
+    std::string signature = std::to_string(std::thread::hardware_concurrency());
+#if defined(__APPLE__)
+    char machine[64] = {0};
+    size_t size = sizeof(machine) - 1;
+    if (sysctlbyname("hw.machine", machine, &size, nullptr, 0) == 0) {
+        signature += machine;
+    }
+#else
+    static const char* kKeys[] = {"model name", "Hardware", "CPU implementer", "CPU part"};
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::set<std::string> lines;
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        for (const char* key : kKeys) {
+            if (line.compare(0, strlen(key), key) == 0) {
+                lines.insert(line);
+            }
+        }
+    }
+    for (const auto& l : lines) {
+        signature += l;
+    }
+#endif
+    return fnv1a(signature.data(), signature.size());
+}
+
+float iou(const FaceInfo& a, const FaceInfo& b) {
+    float w = std::max(0.0f, std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x));
+    float h = std::max(0.0f, std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y));
+    float inter = w * h;
+    float uni = a.width * a.height + b.width * b.height - inter;
+    return uni > 0 ? inter / uni : 0.0f;
+}
+
+const char* filterName(MNN::CV::Filter filter) {
+    switch (filter) {
+        case MNN::CV::NEAREST: return "nearest";
+        case MNN::CV::BILINEAR: return "bilinear";
+        case MNN::CV::BICUBIC: return "bicubic";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+DetectorTuner::DetectorTuner(std::string cacheDir)
+    : cacheDir_(std::move(cacheDir)) {
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    for (int threads : {1, 2, 4}) {
+        if (cores <= 0 || threads <= cores) {
+            threads_.push_back(threads);
+        }
+    }
+    if (cores > 4) {
+        threads_.push_back(cores);
+    }
+}
+
+void DetectorTuner::setIterations(int warmup, int iters) {
+    warmup_ = std::max(0, warmup);
+    iters_ = std::max(1, iters);
+}
+
+void DetectorTuner::setTolerance(float minIoU, float maxScoreDiff) {
+    minIoU_ = minIoU;
+    maxScoreDiff_ = maxScoreDiff;
+}
+
+std::string DetectorTuner::cachePath(const ModelSource& model,
+                                     const DetectorOptions& base) const {
+    // 模型已在内存中（映射或 asset），直接对整段数据求哈希
+    uint64_t modelHash = fnv1a(static_cast<const char*>(model.data()), model.size());
+    char name[96];
+    snprintf(name, sizeof(name), "detector_tune_%016" PRIx64 "_%016" PRIx64 "_%dx%d.cfg",
+             modelHash, cpuSignature(), base.inputWidth, base.inputHeight);
+    return cacheDir_ + "/" + name;
+}
+
+bool DetectorTuner::load(const std::string& path, TuneResult* result) const {
+    std::ifstream file(path);
+    if (!file.good()) {
+        return false;
+    }
+    int threads = 0, precision = -1, filter = -1;
+    double ms = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        sscanf(line.c_str(), "numThreads=%d", &threads);
+        sscanf(line.c_str(), "precision=%d", &precision);
+        sscanf(line.c_str(), "filter=%d", &filter);
+        sscanf(line.c_str(), "detectMs=%lf", &ms);
+    }
+    if (threads < 1 || precision < 0 || precision > MNN::BackendConfig::Precision_Low ||
+        filter < 0 || filter > MNN::CV::BICUBIC) {
+        LOGE("Ignoring malformed tuning file: %s", path.c_str());
+        return false;
+    }
+    result->options.numThreads = threads;
+    result->options.precision = static_cast<MNN::BackendConfig::PrecisionMode>(precision);
+    result->filter = static_cast<MNN::CV::Filter>(filter);
+    result->detectMs = ms;
+    return true;
+}
+
+void DetectorTuner::save(const std::string& path, const TuneResult& result) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.good()) {
+        LOGE("Failed to write tuning file: %s", path.c_str());
+        return;
+    }
+    file << "numThreads=" << result.options.numThreads << "\n"
+         << "precision=" << result.options.precision << "\n"
+         << "filter=" << result.filter << "\n"
+         << "detectMs=" << result.detectMs << "\n";
+}
+
+void DetectorTuner::invalidate(const ModelSource& model, const DetectorOptions& base) {
+    std::remove(cachePath(model, base).c_str());
+}
+
+bool DetectorTuner::withinTolerance(const std::vector<FaceInfo>& reference,
+                                    const std::vector<FaceInfo>& faces) const {
+    if (reference.size() != faces.size()) {
+        return false;
+    }
+    // 每个基准框都要有一个足够重合、分数接近的框
+    for (const FaceInfo& ref : reference) {
+        bool matched = false;
+        for (const FaceInfo& face : faces) {
+            if (iou(ref, face) >= minIoU_ && std::fabs(ref.score - face.score) <= maxScoreDiff_) {
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int DetectorTuner::tune(const ModelSource& model, const cv::Mat& reference,
+                        const DetectorOptions& base, TuneResult* result) {
+    result->options = base;
+    result->filter = MNN::CV::BILINEAR;
+    result->fromCache = false;
+
+    const std::string path = cachePath(model, base);
+    if (load(path, result)) {
+        result->fromCache = true;
+        LOGI("Loaded tuning result: threads=%d, precision=%d, filter=%s",
+             result->options.numThreads, result->options.precision, filterName(result->filter));
+        return 0;
+    }
+
+    // 基准配置的检测结果作为精度参照
+    NativeFaceDetector detector;
+    DetectorOptions options = base;
+    options.precision = MNN::BackendConfig::Precision_High;
+    detector.setPreprocess(PreprocessMode::Fused, MNN::CV::BILINEAR);
+    int ret = detector.init(model, options);
+    if (ret != 0) {
+        return ret;
+    }
+    std::vector<FaceInfo> referenceFaces, faces;
+    detector.detect(reference, &referenceFaces);
+
+    const MNN::BackendConfig::PrecisionMode precisions[] = {
+        MNN::BackendConfig::Precision_High, MNN::BackendConfig::Precision_Normal,
+        MNN::BackendConfig::Precision_Low};
+    const MNN::CV::Filter filters[] = {MNN::CV::NEAREST, MNN::CV::BILINEAR};
+
+    double bestMs = std::numeric_limits<double>::max();
+    std::vector<double> samples(iters_);
+    for (int threads : threads_) {
+        for (auto precision : precisions) {
+            options.numThreads = threads;
+            options.precision = precision;
+            if (detector.init(model, options) != 0) {
+                continue;
+            }
+            for (auto filter : filters) {
+                detector.setPreprocess(PreprocessMode::Fused, filter);
+                for (int i = 0; i < warmup_; ++i) {
+                    detector.detect(reference, &faces);
+                }
+                for (int i = 0; i < iters_; ++i) {
+                    DetectProfile profile;
+                    detector.detect(reference, &faces, &profile);
+                    samples[i] = profile.totalMs;
+                }
+                std::nth_element(samples.begin(), samples.begin() + iters_ / 2, samples.end());
+                double ms = samples[iters_ / 2];
+
+                bool accepted = withinTolerance(referenceFaces, faces);
+                LOGI("threads=%d precision=%d filter=%s: %.2f ms%s", threads, precision,
+                     filterName(filter), ms, accepted ? "" : " (rejected: accuracy)");
+                if (accepted && ms < bestMs) {
+                    bestMs = ms;
+                    result->options = options;
+                    result->filter = filter;
+                    result->detectMs = ms;
+                }
+            }
+        }
+    }
+
+    LOGI("Tuning result: threads=%d, precision=%d, filter=%s, %.2f ms",
+         result->options.numThreads, result->options.precision,
+         filterName(result->filter), result->detectMs);
+    save(path, *result);
+    return 0;
+}
+
+} // namespace facebook::react
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <MNN/ImageProcess.hpp>
+#include <MNN/Interpreter.hpp>
+#include <string>
+#include <vector>
+#include "ModelSource.h"
+#include "NativeFaceDetector.h"
+
+namespace facebook::react {
+
+// 调优结果：在调用方给出的 DetectorOptions 基础上覆盖线程数和精度，另给出预处理滤波器
+struct TuneResult {
+    DetectorOptions options;
+    MNN::CV::Filter filter = MNN::CV::BILINEAR;
+    double detectMs = 0;     // 选中配置的 detect() 中位耗时
+    bool fromCache = false;  // 是否直接读取了已保存的结果
+};
+
+// 启动时自动调优
+// 对每个候选组合（线程数 × 精度 × 滤波器）计时若干次预热后的 detect()，在参考图像上与
+// 基准配置（Precision_High + BILINEAR）的结果比较，选出误差在容忍范围内最快的一个，
+// 保存到 cacheDir 下以模型哈希、CPU 特征和输入尺寸命名的小文件中；之后直接读取。
+class DetectorTuner {
+public:
+    explicit DetectorTuner(std::string cacheDir);
+
+    // 候选线程数（默认 1, 2, 4 和 CPU 核数中不超过核数的值）
+    void setThreadCandidates(std::vector<int> threads) { threads_ = std::move(threads); }
+
+    // 每个候选的预热次数和计时次数（默认 2 / 5）
+    void setIterations(int warmup, int iters);
+
+    // 与基准结果匹配的最小 IoU 和最大分数差（默认 0.9 / 0.02）
+    void setTolerance(float minIoU, float maxScoreDiff);
+
+    // 读取已保存的结果，没有时运行调优并保存；失败时返回 init() 的错误码
+    // model 在调优期间需保持有效（每个候选配置都会从它重新 init）
+    int tune(const ModelSource& model, const cv::Mat& reference,
+             const DetectorOptions& base, TuneResult* result);
+
+    // 删除该模型在当前设备上保存的结果，下次 tune() 会重新调优
+    void invalidate(const ModelSource& model, const DetectorOptions& base);
+
+private:
+    std::string cachePath(const ModelSource& model, const DetectorOptions& base) const;
+    bool load(const std::string& path, TuneResult* result) const;
+    void save(const std::string& path, const TuneResult& result) const;
+    bool withinTolerance(const std::vector<FaceInfo>& reference,
+                         const std::vector<FaceInfo>& faces) const;
+
+    std::string cacheDir_;
+    std::vector<int> threads_;
+    int warmup_ = 2;
+    int iters_ = 5;
+    float minIoU_ = 0.9f;
+    float maxScoreDiff_ = 0.02f;
+};
+
+} // namespace facebook::react
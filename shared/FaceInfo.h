@@ -0,0 +1,16 @@
+#pragma once
+
+namespace facebook::react {
+
+// 人脸信息结构
+struct FaceInfo {
+    float x;        // 人脸框左上角 x
+    float y;        // 人脸框左上角 y
+    float width;    // 人脸框宽度
+    float height;   // 人脸框高度
+    float score;    // 置信度
+
+    FaceInfo() : x(0), y(0), width(0), height(0), score(0) {}
+};
+
+} // namespace facebook::react
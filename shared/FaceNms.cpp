@@ -0,0 +1,265 @@
+#include "FaceNms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+  #define FACE_NMS_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define FACE_NMS_NEON 1
+#endif
+
+namespace facebook::react {
+
+namespace {
+
+// 宽度档：[2^k, 2^(k+1)) 为第 k 档，不足 1 像素的框归入第 0 档
+inline int widthClassOf(float width) {
+    return width >= 1.0f ? std::ilogb(width) : 0;
+}
+
+inline float iouScalar(float ax1, float ay1, float ax2, float ay2, float aArea,
+                       float bx1, float by1, float bx2, float by2, float bArea) {
+    float w = std::max(0.0f, std::min(ax2, bx2) - std::max(ax1, bx1));
+    float h = std::max(0.0f, std::min(ay2, by2) - std::max(ay1, by1));
+    float inter = w * h;
+    return inter / (aArea + bArea - inter);
+}
+
+} // namespace
+
+void NmsEngine::run(const std::vector<FaceInfo>& inputs, const NmsConfig& config,
+                    std::vector<FaceInfo>* result) {
+    result->clear();
+    if (inputs.empty()) return;
+
+    prepare(inputs);
+    switch (config.mode) {
+        case NmsMode::Greedy:
+            runGreedy(inputs, config, result);
+            break;
+        case NmsMode::SoftLinear:
+        case NmsMode::SoftGaussian:
+            runSoft(inputs, config, result);
+            break;
+        case NmsMode::Weighted:
+            runWeighted(inputs, config, result);
+            break;
+    }
+}
+
+void NmsEngine::prepare(const std::vector<FaceInfo>& inputs) {
+    const int n = static_cast<int>(inputs.size());
+
+    widthClass_.resize(n);
+    for (int i = 0; i < n; ++i) {
+        widthClass_[i] = widthClassOf(inputs[i].width);
+    }
+    byX_.resize(n);
+    std::iota(byX_.begin(), byX_.end(), 0);
+    std::sort(byX_.begin(), byX_.end(), [this, &inputs](int a, int b) {
+        return widthClass_[a] < widthClass_[b] ||
+               (widthClass_[a] == widthClass_[b] && inputs[a].x < inputs[b].x);
+    });
+
+    x1_.resize(n);
+    y1_.resize(n);
+    x2_.resize(n);
+    y2_.resize(n);
+    area_.resize(n);
+    scores_.resize(n);
+    iou_.resize(n);
+    classes_.clear();
+    for (int pos = 0; pos < n; ++pos) {
+        const FaceInfo& f = inputs[byX_[pos]];
+        x1_[pos] = f.x;
+        y1_[pos] = f.y;
+        x2_[pos] = f.x + f.width;
+        y2_[pos] = f.y + f.height;
+        area_[pos] = f.width * f.height;
+        scores_[pos] = f.score;
+        if (pos == 0 || widthClass_[byX_[pos]] != widthClass_[byX_[pos - 1]]) {
+            classes_.push_back({pos, pos, 0.0f});
+        }
+        WidthClass& cls = classes_.back();
+        cls.end = pos + 1;
+        cls.maxWidth = std::max(cls.maxWidth, f.width);
+    }
+
+    byScore_.resize(n);
+    std::iota(byScore_.begin(), byScore_.end(), 0);
+    std::sort(byScore_.begin(), byScore_.end(), [this](int a, int b) {
+        return scores_[a] > scores_[b] || (scores_[a] == scores_[b] && byX_[a] < byX_[b]);
+    });
+
+    mask_.assign((n + 63) / 64, 0);
+}
+
+void NmsEngine::overlapRanges(int pos) {
+    // 档内 x1 < x1[pos] - maxWidth 的框右边界不超过 x1[pos]，x1 >= x2[pos] 的框在 x 方向不相交
+    ranges_.clear();
+    for (const WidthClass& cls : classes_) {
+        auto begin = x1_.begin() + cls.begin;
+        auto end = x1_.begin() + cls.end;
+        auto lo = std::lower_bound(begin, end, x1_[pos] - cls.maxWidth);
+        auto hi = std::lower_bound(lo, end, x2_[pos]);
+        if (lo < hi) {
+            ranges_.emplace_back(static_cast<int>(lo - x1_.begin()),
+                                 static_cast<int>(hi - x1_.begin()));
+            computeIoU(pos, ranges_.back().first, ranges_.back().second);
+        }
+    }
+}
+
+void NmsEngine::computeIoU(int pos, int lo, int hi) {
+    const float ax1 = x1_[pos], ay1 = y1_[pos], ax2 = x2_[pos], ay2 = y2_[pos];
+    const float aArea = area_[pos];
+    int j = lo;
+#if defined(FACE_NMS_SSE2)
+    const __m128 vx1 = _mm_set1_ps(ax1), vy1 = _mm_set1_ps(ay1);
+    const __m128 vx2 = _mm_set1_ps(ax2), vy2 = _mm_set1_ps(ay2);
+    const __m128 vArea = _mm_set1_ps(aArea);
+    const __m128 zero = _mm_setzero_ps();
+    for (; j + 4 <= hi; j += 4) {
+        __m128 w = _mm_sub_ps(_mm_min_ps(vx2, _mm_loadu_ps(&x2_[j])),
+                              _mm_max_ps(vx1, _mm_loadu_ps(&x1_[j])));
+        __m128 h = _mm_sub_ps(_mm_min_ps(vy2, _mm_loadu_ps(&y2_[j])),
+                              _mm_max_ps(vy1, _mm_loadu_ps(&y1_[j])));
+        __m128 inter = _mm_mul_ps(_mm_max_ps(w, zero), _mm_max_ps(h, zero));
+        __m128 denom = _mm_sub_ps(_mm_add_ps(vArea, _mm_loadu_ps(&area_[j])), inter);
+        _mm_storeu_ps(&iou_[j], _mm_div_ps(inter, denom));
+    }
+#elif defined(FACE_NMS_NEON)
+    const float32x4_t vx1 = vdupq_n_f32(ax1), vy1 = vdupq_n_f32(ay1);
+    const float32x4_t vx2 = vdupq_n_f32(ax2), vy2 = vdupq_n_f32(ay2);
+    const float32x4_t vArea = vdupq_n_f32(aArea);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for (; j + 4 <= hi; j += 4) {
+        float32x4_t w = vsubq_f32(vminq_f32(vx2, vld1q_f32(&x2_[j])),
+                                  vmaxq_f32(vx1, vld1q_f32(&x1_[j])));
+        float32x4_t h = vsubq_f32(vminq_f32(vy2, vld1q_f32(&y2_[j])),
+                                  vmaxq_f32(vy1, vld1q_f32(&y1_[j])));
+        float32x4_t inter = vmulq_f32(vmaxq_f32(w, zero), vmaxq_f32(h, zero));
+        float32x4_t denom = vsubq_f32(vaddq_f32(vArea, vld1q_f32(&area_[j])), inter);
+#if defined(__aarch64__)
+        vst1q_f32(&iou_[j], vdivq_f32(inter, denom));
+#else
+        // ARMv7 没有向量除法
+        float interBuf[4], denomBuf[4];
+        vst1q_f32(interBuf, inter);
+        vst1q_f32(denomBuf, denom);
+        for (int k = 0; k < 4; ++k) iou_[j + k] = interBuf[k] / denomBuf[k];
+#endif
+    }
+#endif
+    for (; j < hi; ++j) {
+        iou_[j] = iouScalar(ax1, ay1, ax2, ay2, aArea,
+                            x1_[j], y1_[j], x2_[j], y2_[j], area_[j]);
+    }
+}
+
+void NmsEngine::runGreedy(const std::vector<FaceInfo>& inputs, const NmsConfig& config,
+                          std::vector<FaceInfo>* result) {
+    const size_t cap = config.maxDetections > 0 ? config.maxDetections : inputs.size();
+    for (int pos : byScore_) {
+        if (isMasked(pos)) continue;
+        result->push_back(inputs[byX_[pos]]);
+        if (result->size() >= cap) break;
+
+        overlapRanges(pos);
+        for (const auto& [lo, hi] : ranges_) {
+            for (int j = lo; j < hi; ++j) {
+                if (iou_[j] > config.iouThreshold) setMasked(j);
+            }
+        }
+    }
+}
+
+void NmsEngine::runSoft(const std::vector<FaceInfo>& inputs, const NmsConfig& config,
+                        std::vector<FaceInfo>* result) {
+    const size_t cap = config.maxDetections > 0 ? config.maxDetections : inputs.size();
+    const bool gaussian = config.mode == NmsMode::SoftGaussian;
+
+    heap_.clear();
+    for (int pos = 0; pos < static_cast<int>(scores_.size()); ++pos) {
+        heap_.emplace_back(scores_[pos], pos);
+    }
+    std::make_heap(heap_.begin(), heap_.end());
+
+    while (!heap_.empty() && result->size() < cap) {
+        std::pop_heap(heap_.begin(), heap_.end());
+        auto [score, pos] = heap_.back();
+        heap_.pop_back();
+        // 已输出/已丢弃，或分数已被衰减（过期条目）
+        if (isMasked(pos) || score != scores_[pos]) continue;
+        if (score < config.minScore) break;
+
+        setMasked(pos);
+        FaceInfo face = inputs[byX_[pos]];
+        face.score = score;
+        result->push_back(face);
+
+        overlapRanges(pos);
+        for (const auto& [lo, hi] : ranges_) {
+            for (int j = lo; j < hi; ++j) {
+                float iou = iou_[j];
+                if (isMasked(j) || !(iou > 0.0f)) continue;
+                float weight;
+                if (gaussian) {
+                    weight = std::exp(-iou * iou / config.sigma);
+                } else {
+                    weight = iou > config.iouThreshold ? 1.0f - iou : 1.0f;
+                }
+                if (weight >= 1.0f) continue;
+
+                scores_[j] *= weight;
+                if (scores_[j] < config.minScore) {
+                    setMasked(j);
+                } else {
+                    heap_.emplace_back(scores_[j], j);
+                    std::push_heap(heap_.begin(), heap_.end());
+                }
+            }
+        }
+    }
+}
+
+void NmsEngine::runWeighted(const std::vector<FaceInfo>& inputs, const NmsConfig& config,
+                            std::vector<FaceInfo>* result) {
+    const size_t cap = config.maxDetections > 0 ? config.maxDetections : inputs.size();
+    for (int pos : byScore_) {
+        if (isMasked(pos)) continue;
+
+        overlapRanges(pos);
+
+        // 保留框与所有被它抑制的框按分数加权平均
+        float sumX1 = 0, sumY1 = 0, sumX2 = 0, sumY2 = 0, sumW = 0;
+        for (const auto& [lo, hi] : ranges_) {
+            for (int j = lo; j < hi; ++j) {
+                if (isMasked(j) || !(j == pos || iou_[j] > config.iouThreshold)) continue;
+                float w = scores_[j];
+                sumX1 += x1_[j] * w;
+                sumY1 += y1_[j] * w;
+                sumX2 += x2_[j] * w;
+                sumY2 += y2_[j] * w;
+                sumW += w;
+                setMasked(j);
+            }
+        }
+
+        FaceInfo face = inputs[byX_[pos]];
+        if (sumW > 0) {
+            face.x = sumX1 / sumW;
+            face.y = sumY1 / sumW;
+            face.width = sumX2 / sumW - face.x;
+            face.height = sumY2 / sumW - face.y;
+        }
+        result->push_back(face);
+        if (result->size() >= cap) break;
+    }
+}
+
+} // namespace facebook::react
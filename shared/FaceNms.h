@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "FaceInfo.h"
+
+namespace facebook::react {
+
+// NMS 模式
+enum class NmsMode {
+    Greedy,        // 经典 NMS：IoU 超过阈值直接抑制
+    SoftLinear,    // Soft-NMS：IoU 超过阈值时分数乘以 (1 - IoU)
+    SoftGaussian,  // Soft-NMS：分数乘以 exp(-IoU^2 / sigma)
+    Weighted,      // 加权融合：被抑制的框按分数加权融合到保留框
+};
+
+struct NmsConfig {
+    NmsMode mode = NmsMode::Greedy;
+    float iouThreshold = 0.3f;
+    float sigma = 0.5f;         // SoftGaussian 的 sigma
+    float minScore = 0.001f;    // Soft-NMS 衰减后低于该分数的框被丢弃
+    int maxDetections = 0;      // 最多输出的框数，0 表示不限制
+};
+
+// NMS 引擎
+// - 只对下标排序，框按宽度分档（2 的幂），档内按 x1 排好的 SoA 数组做 IoU，每个保留框
+//   只与 x 方向可能重叠的框比较；窗口宽度取各档自己的最大宽度，个别很大的框不会
+//   让所有查询都退化为扫描全部框
+// - 用位图记录抑制状态
+// - 所有临时缓冲在多次调用间复用，稳定后不再分配内存
+// 非线程安全，每个检测线程使用独立实例。
+class NmsEngine {
+public:
+    // 结果按保留顺序（分数从高到低）写入 result
+    void run(const std::vector<FaceInfo>& inputs, const NmsConfig& config,
+             std::vector<FaceInfo>* result);
+
+private:
+    void prepare(const std::vector<FaceInfo>& inputs);
+    // 计算 pos 与 [lo, hi) 内每个框的 IoU，写入 iou_[lo..hi)
+    void computeIoU(int pos, int lo, int hi);
+    // 与 pos 在 x 方向可能重叠的框：每个宽度档一个 [lo, hi) 区间，写入 ranges_，
+    // 并计算这些区间内的 IoU
+    void overlapRanges(int pos);
+
+    void runGreedy(const std::vector<FaceInfo>& inputs, const NmsConfig& config,
+                   std::vector<FaceInfo>* result);
+    void runSoft(const std::vector<FaceInfo>& inputs, const NmsConfig& config,
+                 std::vector<FaceInfo>* result);
+    void runWeighted(const std::vector<FaceInfo>& inputs, const NmsConfig& config,
+                     std::vector<FaceInfo>* result);
+
+    bool isMasked(int pos) const { return (mask_[pos >> 6] >> (pos & 63)) & 1; }
+    void setMasked(int pos) { mask_[pos >> 6] |= uint64_t(1) << (pos & 63); }
+
+    // 一个宽度档在 SoA 数组中的区间 [begin, end) 及档内最大宽度
+    struct WidthClass {
+        int begin;
+        int end;
+        float maxWidth;
+    };
+
+    // 以下数组均按（宽度档, x1）升序排列（下标称为 pos）
+    std::vector<int> byX_;          // pos -> 输入下标
+    std::vector<float> x1_, y1_, x2_, y2_, area_;
+    std::vector<float> scores_;
+    std::vector<float> iou_;
+    std::vector<uint64_t> mask_;    // 已抑制 / 已输出
+    std::vector<int> byScore_;      // 按分数降序排列的 pos
+    std::vector<std::pair<float, int>> heap_;  // Soft-NMS 用的最大堆
+    std::vector<int> widthClass_;   // 输入下标 -> 宽度档
+    std::vector<WidthClass> classes_;
+    std::vector<std::pair<int, int>> ranges_;  // overlapRanges() 的结果
+};
+
+} // namespace facebook::react
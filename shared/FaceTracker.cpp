@@ -0,0 +1,332 @@
+#include "FaceTracker.h"
+#include "Log.h"
+
+#include <opencv2/video/tracking.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <tuple>
+
+#define TAG "FaceTracker"
+
+namespace facebook::react {
+
+namespace {
+
+// LK 光流参数（在光流灰度图上，像素）
+const cv::Size kFlowWindow(15, 15);
+constexpr int kFlowLevels = 2;
+// 前后向跟踪回到起点的最大误差，超过则认为该点不可靠
+constexpr float kMaxForwardBackwardError = 1.0f;
+// 一条轨迹至少需要的可靠点数，否则不更新该轨迹
+constexpr size_t kMinValidPoints = 3;
+// 框内采样点离边缘的比例（边缘点常落在背景上）
+constexpr float kGridMargin = 0.15f;
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+float iou(const FaceInfo& a, const FaceInfo& b) {
+    float w = std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x);
+    float h = std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y);
+    if (w <= 0 || h <= 0) return 0;
+    float inter = w * h;
+    return inter / (a.width * a.height + b.width * b.height - inter);
+}
+
+// 中位数（会打乱 values 的顺序）
+float median(std::vector<float>* values) {
+    auto mid = values->begin() + values->size() / 2;
+    std::nth_element(values->begin(), mid, values->end());
+    return *mid;
+}
+
+// PixelBuffer 格式 -> (cv::Mat 类型, 转灰度的 cvtColor 转换码)；YUV 直接取 Y 平面
+bool grayConversion(MNN::CV::ImageFormat format, int* type, int* code) {
+    switch (format) {
+        case MNN::CV::RGBA: *type = CV_8UC4; *code = cv::COLOR_RGBA2GRAY; return true;
+        case MNN::CV::BGRA: *type = CV_8UC4; *code = cv::COLOR_BGRA2GRAY; return true;
+        case MNN::CV::RGB:  *type = CV_8UC3; *code = cv::COLOR_RGB2GRAY; return true;
+        case MNN::CV::BGR:  *type = CV_8UC3; *code = cv::COLOR_BGR2GRAY; return true;
+        case MNN::CV::GRAY:
+        case MNN::CV::YUV_NV21:
+        case MNN::CV::YUV_NV12: *type = CV_8UC1; *code = -1; return true;
+        default: return false;
+    }
+}
+
+} // namespace
+
+FaceTracker::FaceTracker(std::shared_ptr<NativeFaceDetector> detector,
+                         const TrackerOptions& options)
+    : detector_(std::move(detector)) {
+    if (setOptions(options) != 0) {
+        LOGE("Invalid tracker options, using defaults");
+        options_ = TrackerOptions();
+    }
+}
+
+bool FaceTracker::validOptions(const TrackerOptions& options) {
+    return options.detectInterval >= 1 && options.gridSize >= 2 && options.flowMaxSide >= 16 &&
+           options.smoothing >= 0 && options.smoothing < 1 &&
+           options.matchIoU >= 0 && options.matchIoU <= 1;
+}
+
+int FaceTracker::setOptions(const TrackerOptions& options) {
+    if (!validOptions(options)) {
+        return 10003;
+    }
+    options_ = options;
+    reset();
+    return 0;
+}
+
+void FaceTracker::reset() {
+    tracks_.clear();
+    prevGray_.release();
+    sinceDetection_ = 0;
+}
+
+int FaceTracker::process(const cv::Mat& frame, std::vector<TrackedFace>* faces,
+                         TrackProfile* profile) {
+    faces->clear();
+    if (frame.empty()) {
+        LOGE("Input frame is empty");
+        return 10001;
+    }
+    int code = frame.channels() == 4 ? cv::COLOR_BGRA2GRAY
+             : frame.channels() == 3 ? cv::COLOR_BGR2GRAY : -1;
+    return processFrame(frame, code, [&](std::vector<FaceInfo>* detected) {
+        return detector_->detect(frame, detected, nullptr, options_.input);
+    }, faces, profile);
+}
+
+int FaceTracker::process(const PixelBuffer& frame, std::vector<TrackedFace>* faces,
+                         TrackProfile* profile) {
+    faces->clear();
+    int type = 0;
+    int code = -1;
+    if (frame.data == nullptr || frame.width <= 0 || frame.height <= 0) {
+        LOGE("Input frame is empty");
+        return 10001;
+    }
+    if (!grayConversion(frame.format, &type, &code)) {
+        LOGE("Unsupported pixel format: %d", frame.format);
+        return 10003;
+    }
+    // 只包装，不拷贝
+    cv::Mat src(frame.height, frame.width, type, const_cast<uint8_t*>(frame.data),
+                frame.stride > 0 ? static_cast<size_t>(frame.stride)
+                                 : static_cast<size_t>(cv::Mat::AUTO_STEP));
+    return processFrame(src, code, [&](std::vector<FaceInfo>* detected) {
+        return detector_->detect(frame, detected, nullptr, options_.input);
+    }, faces, profile);
+}
+
+template <typename DetectFn>
+int FaceTracker::processFrame(const cv::Mat& src, int code, DetectFn&& detect,
+                              std::vector<TrackedFace>* faces, TrackProfile* profile) {
+    auto start = std::chrono::steady_clock::now();
+    TrackProfile stage;
+    if (!detector_) {
+        LOGE("Model not initialized");
+        return 10000;
+    }
+    ++frames_;
+
+    toFlowGray(src, code);
+    stage.grayMs = elapsedMs(start);
+
+    // 先把已有轨迹传播到当前帧：非检测帧直接输出，检测帧用于和检测框关联
+    float quality = 1.0f;
+    bool flowValid = !prevGray_.empty() && prevGray_.size() == gray_.size();
+    if (flowValid && !tracks_.empty()) {
+        auto flowStart = std::chrono::steady_clock::now();
+        quality = propagate(src.cols, src.rows);
+        stage.flowMs = elapsedMs(flowStart);
+    }
+
+    bool detectNow = !flowValid || sinceDetection_ + 1 >= options_.detectInterval ||
+                     quality < options_.minTrackQuality;
+    if (detectNow) {
+        auto detectStart = std::chrono::steady_clock::now();
+        int ret = detect(&detected_);
+        if (ret != 0) {
+            // 轨迹已传播到当前帧，下一帧仍可从它们继续跟踪
+            std::swap(prevGray_, gray_);
+            LOGE("Detection failed, error code: %d", ret);
+            return ret;
+        }
+        associate(detected_);
+        sinceDetection_ = 0;
+        ++detections_;
+        stage.detectMs = elapsedMs(detectStart);
+    } else {
+        ++sinceDetection_;
+    }
+    std::swap(prevGray_, gray_);
+
+    faces->reserve(tracks_.size());
+    for (const Track& track : tracks_) {
+        TrackedFace tracked;
+        tracked.face = track.face;
+        tracked.id = track.id;
+        tracked.detected = detectNow;
+        faces->push_back(tracked);
+    }
+
+    if (profile) {
+        stage.detected = detectNow;
+        stage.totalMs = elapsedMs(start);
+        *profile = stage;
+    }
+    return 0;
+}
+
+void FaceTracker::toFlowGray(const cv::Mat& src, int code) {
+    flowScale_ = std::min(1.0f, static_cast<float>(options_.flowMaxSide) /
+                                std::max(src.cols, src.rows));
+    // 先缩小再转灰度，转换的像素更少
+    const cv::Mat* scaled = &src;
+    if (flowScale_ < 1.0f) {
+        cv::Size size(std::max(1, static_cast<int>(std::lround(src.cols * flowScale_))),
+                      std::max(1, static_cast<int>(std::lround(src.rows * flowScale_))));
+        cv::resize(src, scaled_, size, 0, 0, cv::INTER_AREA);
+        scaled = &scaled_;
+    }
+    if (code >= 0) {
+        cv::cvtColor(*scaled, gray_, code);
+    } else {
+        // 可能直接引用调用方的缓冲区，需要拷贝一份留给下一帧
+        scaled->copyTo(gray_);
+    }
+}
+
+float FaceTracker::propagate(int width, int height) {
+    const int grid = options_.gridSize;
+    const size_t perTrack = static_cast<size_t>(grid) * grid;
+    const float scale = flowScale_;
+
+    // 所有轨迹的采样点放在一起，一次光流调用
+    points_.clear();
+    for (const Track& track : tracks_) {
+        const FaceInfo& f = track.face;
+        for (int gy = 0; gy < grid; ++gy) {
+            for (int gx = 0; gx < grid; ++gx) {
+                float u = kGridMargin + (1.0f - 2 * kGridMargin) * gx / (grid - 1);
+                float v = kGridMargin + (1.0f - 2 * kGridMargin) * gy / (grid - 1);
+                points_.emplace_back((f.x + u * f.width) * scale, (f.y + v * f.height) * scale);
+            }
+        }
+    }
+
+    cv::calcOpticalFlowPyrLK(prevGray_, gray_, points_, nextPoints_, status_, error_,
+                             kFlowWindow, kFlowLevels);
+    cv::calcOpticalFlowPyrLK(gray_, prevGray_, nextPoints_, backPoints_, backStatus_, error_,
+                             kFlowWindow, kFlowLevels);
+
+    float minQuality = 1.0f;
+    std::vector<Track> kept;
+    kept.reserve(tracks_.size());
+    std::vector<size_t> valid;
+    valid.reserve(perTrack);
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+        const size_t base = t * perTrack;
+        valid.clear();
+        dx_.clear();
+        dy_.clear();
+        for (size_t k = base; k < base + perTrack; ++k) {
+            cv::Point2f back = backPoints_[k] - points_[k];
+            if (status_[k] && backStatus_[k] &&
+                back.dot(back) < kMaxForwardBackwardError * kMaxForwardBackwardError) {
+                valid.push_back(k);
+                dx_.push_back(nextPoints_[k].x - points_[k].x);
+                dy_.push_back(nextPoints_[k].y - points_[k].y);
+            }
+        }
+        float quality = static_cast<float>(valid.size()) / perTrack;
+        minQuality = std::min(minQuality, quality);
+
+        Track track = tracks_[t];
+        if (valid.size() >= kMinValidPoints) {
+            // Median Flow：平移取位移中位数，缩放取点对距离比的中位数
+            ratios_.clear();
+            for (size_t i = 0; i < valid.size(); ++i) {
+                for (size_t j = i + 1; j < valid.size(); ++j) {
+                    float before = cv::norm(points_[valid[i]] - points_[valid[j]]);
+                    float after = cv::norm(nextPoints_[valid[i]] - nextPoints_[valid[j]]);
+                    if (before > 1.0f) ratios_.push_back(after / before);
+                }
+            }
+            float ratio = ratios_.empty() ? 1.0f : median(&ratios_);
+            float centerX = track.face.x + track.face.width / 2 + median(&dx_) / scale;
+            float centerY = track.face.y + track.face.height / 2 + median(&dy_) / scale;
+            track.face.width *= ratio;
+            track.face.height *= ratio;
+            track.face.x = centerX - track.face.width / 2;
+            track.face.y = centerY - track.face.height / 2;
+        }
+
+        // 中心移出画面的轨迹丢弃，其余裁剪到画面内（与检测输出一致）
+        float centerX = track.face.x + track.face.width / 2;
+        float centerY = track.face.y + track.face.height / 2;
+        if (centerX < 0 || centerY < 0 || centerX >= width || centerY >= height) {
+            continue;
+        }
+        track.face.width = std::min(track.face.width, static_cast<float>(width));
+        track.face.height = std::min(track.face.height, static_cast<float>(height));
+        track.face.x = std::min(std::max(track.face.x, 0.0f), width - track.face.width);
+        track.face.y = std::min(std::max(track.face.y, 0.0f), height - track.face.height);
+        kept.push_back(track);
+    }
+    tracks_.swap(kept);
+    return minQuality;
+}
+
+void FaceTracker::associate(const std::vector<FaceInfo>& detections) {
+    // (IoU, 轨迹下标, 检测下标)，按 IoU 从高到低贪心匹配
+    std::vector<std::tuple<float, int, int>> pairs;
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+        for (size_t d = 0; d < detections.size(); ++d) {
+            float overlap = iou(tracks_[t].face, detections[d]);
+            if (overlap >= options_.matchIoU) {
+                pairs.emplace_back(overlap, static_cast<int>(t), static_cast<int>(d));
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) {
+        return std::get<0>(a) > std::get<0>(b);
+    });
+
+    std::vector<int> trackOf(detections.size(), -1);
+    std::vector<bool> trackUsed(tracks_.size(), false);
+    for (const auto& [overlap, t, d] : pairs) {
+        if (trackUsed[t] || trackOf[d] >= 0) continue;
+        trackUsed[t] = true;
+        trackOf[d] = t;
+    }
+
+    // 检测结果决定当前帧有哪些脸：关联上的沿用 ID 并与旧框加权平滑，其余新建轨迹
+    const float keep = options_.smoothing;
+    std::vector<Track> updated;
+    updated.reserve(detections.size());
+    for (size_t d = 0; d < detections.size(); ++d) {
+        Track track;
+        track.face = detections[d];
+        if (trackOf[d] >= 0) {
+            const Track& old = tracks_[trackOf[d]];
+            track.id = old.id;
+            track.face.x = keep * old.face.x + (1 - keep) * track.face.x;
+            track.face.y = keep * old.face.y + (1 - keep) * track.face.y;
+            track.face.width = keep * old.face.width + (1 - keep) * track.face.width;
+            track.face.height = keep * old.face.height + (1 - keep) * track.face.height;
+        } else {
+            track.id = nextId_++;
+        }
+        updated.push_back(track);
+    }
+    tracks_.swap(updated);
+}
+
+} // namespace facebook::react
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "NativeFaceDetector.h"
+
+namespace facebook::react {
+
+// 视频模式参数
+struct TrackerOptions {
+    int detectInterval = 5;        // 每隔多少帧做一次全量检测，1 表示每帧检测
+    float minTrackQuality = 0.5f;  // 某条轨迹光流可靠点的比例低于它时，本帧改做全量检测
+    float matchIoU = 0.3f;         // 检测框与已有轨迹关联的最小 IoU
+    float smoothing = 0.3f;        // 关联成功时保留旧框的权重，0 表示直接采用检测框
+    int flowMaxSide = 320;         // 光流在长边缩放到不超过该值的灰度图上计算
+    int gridSize = 5;              // 每个框内 gridSize x gridSize 个跟踪点
+    InputConfig input;             // 全量检测的模型输入
+};
+
+// 带轨迹 ID 的人脸
+struct TrackedFace {
+    FaceInfo face;
+    int id = 0;              // 轨迹 ID，同一张脸在各帧之间保持不变
+    bool detected = false;   // 本帧的框来自全量检测（否则为光流传播）
+};
+
+// 单帧耗时（毫秒）
+struct TrackProfile {
+    bool detected = false;  // 本帧是否运行了全量检测
+    double grayMs = 0;      // 缩放 + 灰度转换
+    double flowMs = 0;      // 光流传播
+    double detectMs = 0;    // 全量检测 + 关联
+    double totalMs = 0;
+};
+
+// 视频模式：检测 + 跟踪
+// 每 detectInterval 帧（或某条轨迹的光流质量过低时）运行一次 NativeFaceDetector::detect()，
+// 其余帧用稀疏光流（金字塔 LK，前后向一致性校验）把上一帧的框平移、缩放到当前帧，
+// 不做推理。检测帧按 IoU 把检测框关联到已有轨迹以保持 ID，未关联的轨迹被丢弃。
+// 每路视频流一个实例，process() 不能并发调用；检测器可被多个实例共享。
+class FaceTracker {
+public:
+    explicit FaceTracker(std::shared_ptr<NativeFaceDetector> detector,
+                         const TrackerOptions& options = TrackerOptions());
+
+    // 修改参数并清空轨迹；参数不合法（见 validOptions）时返回 10003
+    int setOptions(const TrackerOptions& options);
+    static bool validOptions(const TrackerOptions& options);
+    const TrackerOptions& options() const { return options_; }
+
+    // 处理一帧，faces 为当前帧所有轨迹；返回 detect() 的错误码
+    int process(const cv::Mat& frame, std::vector<TrackedFace>* faces,
+                TrackProfile* profile = nullptr);
+    int process(const PixelBuffer& frame, std::vector<TrackedFace>* faces,
+                TrackProfile* profile = nullptr);
+
+    // 清空轨迹，下一帧重新检测（如切换摄像头）
+    void reset();
+
+    uint64_t frames() const { return frames_; }
+    uint64_t detections() const { return detections_; }
+
+private:
+    struct Track {
+        FaceInfo face;  // 原图坐标
+        int id = 0;
+    };
+
+    // 两种帧共用的流程：src 转成光流灰度图后传播轨迹，需要时调用 detect 做全量检测。
+    // code 为 src 转灰度的 cvtColor 转换码，-1 表示 src 已是灰度
+    template <typename DetectFn>
+    int processFrame(const cv::Mat& src, int code, DetectFn&& detect,
+                     std::vector<TrackedFace>* faces, TrackProfile* profile);
+
+    // 把 src 缩放到光流尺寸后转成灰度，写入 gray_ 并更新 flowScale_
+    void toFlowGray(const cv::Mat& src, int code);
+
+    // 用光流把轨迹从 prevGray_ 传播到 gray_，返回所有轨迹中最低的可靠点比例
+    float propagate(int width, int height);
+
+    // 按 IoU 从高到低贪心关联检测框和轨迹，更新 tracks_
+    void associate(const std::vector<FaceInfo>& detections);
+
+    std::shared_ptr<NativeFaceDetector> detector_;
+    TrackerOptions options_;
+    std::vector<Track> tracks_;
+    int nextId_ = 1;
+    int sinceDetection_ = 0;  // 距上次全量检测的帧数
+    uint64_t frames_ = 0;
+    uint64_t detections_ = 0;
+
+    // 当前帧 / 上一帧的光流灰度图，及其相对原图的缩放比例
+    cv::Mat gray_;
+    cv::Mat prevGray_;
+    float flowScale_ = 1.0f;
+    cv::Mat scaled_;
+
+    // 临时缓冲，跨帧复用
+    std::vector<cv::Point2f> points_;
+    std::vector<cv::Point2f> nextPoints_;
+    std::vector<cv::Point2f> backPoints_;
+    std::vector<uchar> status_;
+    std::vector<uchar> backStatus_;
+    std::vector<float> error_;
+    std::vector<FaceInfo> detected_;
+    std::vector<float> dx_;
+    std::vector<float> dy_;
+    std::vector<float> ratios_;
+};
+
+} // namespace facebook::react
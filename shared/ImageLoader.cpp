@@ -0,0 +1,240 @@
+// AImageDecoder 从 Android 11（API 30）开始提供，minSdk 更低时以弱符号引用，
+// 运行时用 __builtin_available 判断。必须在包含任何系统头文件之前定义
+#ifdef __ANDROID__
+  #define __ANDROID_UNAVAILABLE_SYMBOLS_ARE_WEAK__
+#endif
+
+#include "ImageLoader.h"
+#include "PerfStats.h"
+#include "Log.h"
+
+// 平台特定的头文件
+#ifdef __ANDROID__
+  #include <android/bitmap.h>
+  #include <android/imagedecoder.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#if defined(__APPLE__)
+  #include <CoreGraphics/CoreGraphics.h>
+  #include <ImageIO/ImageIO.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+
+#define TAG "ImageLoader"
+
+namespace facebook::react {
+
+namespace {
+
+#if defined(__APPLE__)
+
+// ImageIO 生成长边为 (max(width, height) / sampleSize) 的缩略图并应用 EXIF 方向；
+// JPEG 缩略图直接按 DCT 缩放解码
+bool decodeSampled(const std::string& path, int width, int height, int sampleSize,
+                   cv::Mat* bgr) {
+    CFURLRef url = CFURLCreateFromFileSystemRepresentation(
+        nullptr, reinterpret_cast<const UInt8*>(path.c_str()), static_cast<CFIndex>(path.size()),
+        false);
+    if (url == nullptr) {
+        return false;
+    }
+    CGImageSourceRef source = CGImageSourceCreateWithURL(url, nullptr);
+    CFRelease(url);
+    if (source == nullptr) {
+        return false;
+    }
+
+    int maxSide = (std::max(width, height) + sampleSize - 1) / sampleSize;
+    CFNumberRef maxSideNumber = CFNumberCreate(nullptr, kCFNumberIntType, &maxSide);
+    const void* keys[] = {kCGImageSourceCreateThumbnailFromImageAlways,
+                          kCGImageSourceCreateThumbnailWithTransform,
+                          kCGImageSourceThumbnailMaxPixelSize};
+    const void* values[] = {kCFBooleanTrue, kCFBooleanTrue, maxSideNumber};
+    CFDictionaryRef options = CFDictionaryCreate(nullptr, keys, values, 3,
+                                                 &kCFTypeDictionaryKeyCallBacks,
+                                                 &kCFTypeDictionaryValueCallBacks);
+    CGImageRef image = CGImageSourceCreateThumbnailAtIndex(source, 0, options);
+    CFRelease(options);
+    CFRelease(maxSideNumber);
+    CFRelease(source);
+    if (image == nullptr) {
+        return false;
+    }
+
+    const int outWidth = static_cast<int>(CGImageGetWidth(image));
+    const int outHeight = static_cast<int>(CGImageGetHeight(image));
+    cv::Mat rgba(outHeight, outWidth, CV_8UC4);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(
+        rgba.data, outWidth, outHeight, 8, rgba.step[0], colorSpace,
+        kCGImageAlphaNoneSkipLast | kCGBitmapByteOrder32Big);
+    CGColorSpaceRelease(colorSpace);
+    if (context == nullptr) {
+        CGImageRelease(image);
+        return false;
+    }
+    CGContextDrawImage(context, CGRectMake(0, 0, outWidth, outHeight), image);
+    CGContextRelease(context);
+    CGImageRelease(image);
+    cv::cvtColor(rgba, *bgr, cv::COLOR_RGBA2BGR);
+    return true;
+}
+
+#elif defined(__ANDROID__)
+
+// AImageDecoder 按 sampleSize 采样解码（JPEG 由 libjpeg-turbo 在 DCT 域缩放）并应用 EXIF 方向；
+// Android 11 以下返回 false
+bool decodeSampled(const std::string& path, int, int, int sampleSize, cv::Mat* bgr) {
+    if (__builtin_available(android 30, *)) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        AImageDecoder* decoder = nullptr;
+        bool ok = AImageDecoder_createFromFd(fd, &decoder) == ANDROID_IMAGE_DECODER_SUCCESS;
+        int32_t outWidth = 0;
+        int32_t outHeight = 0;
+        ok = ok && AImageDecoder_setAndroidBitmapFormat(decoder, ANDROID_BITMAP_FORMAT_RGBA_8888) ==
+                       ANDROID_IMAGE_DECODER_SUCCESS;
+        ok = ok && AImageDecoder_computeSampledSize(decoder, sampleSize, &outWidth, &outHeight) ==
+                       ANDROID_IMAGE_DECODER_SUCCESS;
+        ok = ok && AImageDecoder_setTargetSize(decoder, outWidth, outHeight) ==
+                       ANDROID_IMAGE_DECODER_SUCCESS;
+        cv::Mat rgba;
+        if (ok) {
+            rgba.create(outHeight, outWidth, CV_8UC4);
+            ok = AImageDecoder_decodeImage(decoder, rgba.data, rgba.step[0],
+                                           rgba.step[0] * rgba.rows) == ANDROID_IMAGE_DECODER_SUCCESS;
+        }
+        if (decoder != nullptr) {
+            AImageDecoder_delete(decoder);
+        }
+        close(fd);
+        if (!ok) {
+            return false;
+        }
+        cv::cvtColor(rgba, *bgr, cv::COLOR_RGBA2BGR);
+        return true;
+    }
+    return false;
+}
+
+#elif defined(HAVE_OPENCV_IMGCODECS)
+
+// 完整版 OpenCV：libjpeg 按 1/2、1/4、1/8 缩放解码，imread 默认应用 EXIF 方向
+bool decodeSampled(const std::string& path, int, int, int sampleSize, cv::Mat* bgr) {
+    int flags = sampleSize == 8 ? cv::IMREAD_REDUCED_COLOR_8
+              : sampleSize == 4 ? cv::IMREAD_REDUCED_COLOR_4
+                                : cv::IMREAD_REDUCED_COLOR_2;
+    *bgr = cv::imread(path, flags);
+    return !bgr->empty();
+}
+
+#else
+
+// opencv-mobile 等不支持缩小解码的构建
+bool decodeSampled(const std::string&, int, int, int, cv::Mat*) {
+    return false;
+}
+
+#endif
+
+uint16_t readBigEndian16(std::istream& in) {
+    int high = in.get();
+    int low = in.get();
+    return static_cast<uint16_t>(((high & 0xFF) << 8) | (low & 0xFF));
+}
+
+} // namespace
+
+int chooseSampleSize(int width, int height, int minWidth, int minHeight) {
+    const int longSide = std::max(width, height);
+    const int shortSide = std::min(width, height);
+    const int minLong = std::max(minWidth, minHeight);
+    const int minShort = std::min(minWidth, minHeight);
+    for (int sample = 8; sample > 1; sample /= 2) {
+        if (longSide / sample >= minLong && shortSide / sample >= minShort) {
+            return sample;
+        }
+    }
+    return 1;
+}
+
+bool readJpegSize(const std::string& path, int* width, int* height) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file || file.get() != 0xFF || file.get() != 0xD8) {
+        return false;
+    }
+    // 逐段跳过 APPn（EXIF 缩略图可能有几十 KB）等，直到帧头 SOFn
+    while (file) {
+        int marker = file.get();
+        if (marker != 0xFF) {
+            return false;
+        }
+        while (marker == 0xFF) {
+            marker = file.get();  // 段之间允许填充 0xFF
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            continue;  // 无长度字段的标记
+        }
+        if (marker == 0xD9 || marker == 0xDA || marker == std::char_traits<char>::eof()) {
+            return false;  // 在 SOF 之前遇到 EOI / SOS
+        }
+        uint16_t length = readBigEndian16(file);
+        if (length < 2) {
+            return false;
+        }
+        // SOF0..SOF15，C4（DHT）、C8（保留）、CC（DAC）除外
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+            marker != 0xCC) {
+            file.get();  // 采样精度
+            *height = readBigEndian16(file);
+            *width = readBigEndian16(file);
+            return file.good() && *width > 0 && *height > 0;
+        }
+        file.seekg(length - 2, std::ios::cur);
+    }
+    return false;
+}
+
+bool loadImageForDetection(const std::string& path, int minWidth, int minHeight,
+                           LoadedImage* out) {
+    ScopedPerfTimer timer(PerfStage::ImageLoad);
+    *out = LoadedImage();
+    int width = 0;
+    int height = 0;
+    int sampleSize = 1;
+    if (readJpegSize(path, &width, &height)) {
+        sampleSize = chooseSampleSize(width, height, minWidth, minHeight);
+    }
+
+    if (sampleSize > 1 && decodeSampled(path, width, height, sampleSize, &out->image)) {
+        // 解码结果可能已按 EXIF 方向转置，文件头中的宽高随之交换
+        const bool transposed = (width > height && out->image.cols < out->image.rows) ||
+                                (width < height && out->image.cols > out->image.rows);
+        out->originalWidth = transposed ? height : width;
+        out->originalHeight = transposed ? width : height;
+        out->scaleX = static_cast<float>(out->originalWidth) / out->image.cols;
+        out->scaleY = static_cast<float>(out->originalHeight) / out->image.rows;
+        out->sampleSize = sampleSize;
+        return true;
+    }
+    if (sampleSize > 1) {
+        LOGD("Reduced decode unavailable, decoding %s at full size", path.c_str());
+    }
+
+    out->image = cv::imread(path);
+    if (out->image.empty()) {
+        return false;
+    }
+    out->originalWidth = out->image.cols;
+    out->originalHeight = out->image.rows;
+    return true;
+}
+
+} // namespace facebook::react
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+namespace facebook::react {
+
+// 为检测加载的图像
+// image 可能是缩小解码的结果，原图坐标 = image 中的坐标 * (scaleX, scaleY)
+struct LoadedImage {
+    cv::Mat image;           // BGR
+    int originalWidth = 0;   // 原图尺寸（与 image 方向相同）
+    int originalHeight = 0;
+    float scaleX = 1.0f;
+    float scaleY = 1.0f;
+    int sampleSize = 1;      // 解码时的缩小倍数：1 / 2 / 4 / 8
+};
+
+// 按检测所需的分辨率加载图像：JPEG 先读文件头中的尺寸，在缩小后仍不小于
+// minWidth x minHeight（按长短边比较，与 EXIF 方向无关）的前提下选最大的缩小倍数，
+// 在 DCT 域缩小解码，不产生全尺寸像素：
+// - iOS：ImageIO 缩略图解码（CGImageSourceCreateThumbnailAtIndex）
+// - Android 11+：AImageDecoder 按采样尺寸解码
+// - 桌面 OpenCV：IMREAD_REDUCED_COLOR_2/4/8
+// 其他格式、不需要缩小或平台不支持时按原尺寸 cv::imread。失败时返回 false
+bool loadImageForDetection(const std::string& path, int minWidth, int minHeight,
+                           LoadedImage* out);
+
+// 缩小倍数（1 / 2 / 4 / 8）：缩小后长边不小于 max(minWidth, minHeight)，短边不小于
+// min(minWidth, minHeight) 的最大值
+int chooseSampleSize(int width, int height, int minWidth, int minHeight);
+
+// 读取 JPEG 文件头（SOF 段）中的尺寸，不解码像素（EXIF 方向未应用）；
+// 不是 JPEG 或文件头损坏时返回 false
+bool readJpegSize(const std::string& path, int* width, int* height);
+
+} // namespace facebook::react
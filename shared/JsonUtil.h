@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+namespace facebook::react {
+
+// 转义 JSON 字符串中的引号、反斜杠和控制字符（不含两侧引号）。
+// 路径、模型 id、算子名等外部来源的文本拼入 JSON 前都要经过这里
+inline std::string jsonEscape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+} // namespace facebook::react
@@ -0,0 +1,147 @@
+#include "Log.h"
+
+#ifdef __ANDROID__
+  #include <android/log.h>
+#endif
+
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace facebook::react {
+
+namespace {
+
+constexpr size_t kSlots = 128;
+constexpr size_t kMessageSize = 1024;  // 更长的消息（如算子耗时表）直接同步写出
+
+struct LogSlot {
+    int level = FD_LOG_INFO;
+    const char* tag = "";  // TAG 都是字符串字面量，只保存指针
+    char message[kMessageSize];
+};
+
+const char* levelPrefix(int level) {
+    switch (level) {
+        case FD_LOG_VERBOSE: return "[VERBOSE]";
+        case FD_LOG_DEBUG: return "[DEBUG]";
+        case FD_LOG_INFO: return "[INFO]";
+        case FD_LOG_WARN: return "[WARN]";
+        default: return "[ERROR]";
+    }
+}
+
+void writeLog(int level, const char* tag, const char* message) {
+#ifdef __ANDROID__
+    __android_log_write(level, tag, message);
+#else
+    (void)tag;
+    fprintf(level >= FD_LOG_WARN ? stderr : stdout, "%s %s\n", levelPrefix(level), message);
+#endif
+}
+
+// 多生产者、单写出线程的环形缓冲区。入队只在锁内拷贝一次已格式化的消息，
+// 写出（系统调用）在锁外进行
+class AsyncLogSink {
+public:
+    AsyncLogSink() {
+        std::thread(&AsyncLogSink::drain, this).detach();
+    }
+
+    void push(int level, const char* tag, const char* message, size_t length) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pushed_ - written_ >= kSlots) {
+            ++dropped_;
+            return;
+        }
+        LogSlot& slot = slots_[pushed_ % kSlots];
+        slot.level = level;
+        slot.tag = tag;
+        memcpy(slot.message, message, length + 1);
+        ++pushed_;
+        readyCv_.notify_one();
+    }
+
+    // 等待调用前已入队的消息全部写出
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const uint64_t target = pushed_;
+        drainedCv_.wait(lock, [&] { return written_ >= target; });
+    }
+
+private:
+    void drain() {
+        LogSlot slot;
+        uint64_t reportedDropped = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            readyCv_.wait(lock, [this] { return written_ < pushed_; });
+            slot = slots_[written_ % kSlots];
+            const uint64_t dropped = dropped_;
+            lock.unlock();
+
+            if (dropped > reportedDropped) {
+                char notice[64];
+                snprintf(notice, sizeof(notice), "%llu log messages dropped",
+                         static_cast<unsigned long long>(dropped - reportedDropped));
+                writeLog(FD_LOG_WARN, "Log", notice);
+                reportedDropped = dropped;
+            }
+            writeLog(slot.level, slot.tag, slot.message);
+
+            lock.lock();
+            ++written_;  // 写完才释放该槽位，flush() 据此判断
+            drainedCv_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable readyCv_;
+    std::condition_variable drainedCv_;
+    LogSlot slots_[kSlots];
+    uint64_t pushed_ = 0;
+    uint64_t written_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+// 有意不释放：写出线程已分离，进程退出时析构会与它竞争
+AsyncLogSink& asyncSink() {
+    static AsyncLogSink* sink = new AsyncLogSink();
+    return *sink;
+}
+
+} // namespace
+
+void logAsync(int level, const char* tag, const char* fmt, ...) {
+    char message[kMessageSize];
+    va_list args;
+    va_start(args, fmt);
+    const int length = vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+
+    AsyncLogSink& sink = asyncSink();
+    if (level < FD_LOG_ERROR && static_cast<size_t>(length) < sizeof(message)) {
+        sink.push(level, tag, message, static_cast<size_t>(length));
+        return;
+    }
+    sink.flush();
+    if (static_cast<size_t>(length) < sizeof(message)) {
+        writeLog(level, tag, message);
+        return;
+    }
+    std::string full(static_cast<size_t>(length), '\0');
+    va_start(args, fmt);
+    vsnprintf(&full[0], full.size() + 1, fmt, args);
+    va_end(args);
+    writeLog(level, tag, full.c_str());
+}
+
+} // namespace facebook::react
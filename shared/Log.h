@@ -0,0 +1,91 @@
+#pragma once
+
+// 日志宏 LOGV / LOGD / LOGI / LOGW / LOGE，TAG 由包含方在使用前定义。
+//
+// 级别在编译期过滤：低于 FD_LOG_LEVEL 的宏不产生代码，参数不求值、不格式化。
+// 默认定义了 NDEBUG（Release 构建）时为 INFO，否则为 DEBUG。每帧 / 每张图都会执行的
+// 日志只用 LOGD / LOGV；预期内的退化（如模型缓冲已释放时逐个推理）每个对象只 LOGW 一次，
+// 之后用 LOGD。Release 构建的检测路径上因此只有调用失败时才有日志。
+//
+// FD_LOG_ASYNC=1（调试构建使用）：消息在调用线程格式化后放入固定大小的环形缓冲区，
+// 由后台线程写出，调用线程不等待 logcat / stdout；缓冲区满时丢弃并记录丢弃条数。
+// LOGE 先等待已入队的消息写完再同步写出，保证顺序，随后崩溃也不会丢失。
+
+// 级别取值与 Android 日志优先级（ANDROID_LOG_*）一致
+#define FD_LOG_VERBOSE 2
+#define FD_LOG_DEBUG 3
+#define FD_LOG_INFO 4
+#define FD_LOG_WARN 5
+#define FD_LOG_ERROR 6
+#define FD_LOG_SILENT 8
+
+#ifndef FD_LOG_LEVEL
+  #ifdef NDEBUG
+    #define FD_LOG_LEVEL FD_LOG_INFO
+  #else
+    #define FD_LOG_LEVEL FD_LOG_DEBUG
+  #endif
+#endif
+
+#ifndef FD_LOG_ASYNC
+  #define FD_LOG_ASYNC 0
+#endif
+
+namespace facebook::react {
+
+// 异步输出：格式化后入队（LOGE 除外，见上）。由日志宏调用
+void logAsync(int level, const char* tag, const char* fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+} // namespace facebook::react
+
+#if FD_LOG_ASYNC
+  #define FD_LOG(level, prefix, fmt, ...) \
+      ::facebook::react::logAsync(level, TAG, fmt, ##__VA_ARGS__)
+#elif defined(__ANDROID__)
+  #include <android/log.h>
+  #define FD_LOG(level, prefix, fmt, ...) __android_log_print(level, TAG, fmt, ##__VA_ARGS__)
+#else
+  #include <cstdio>
+  #define FD_LOG(level, prefix, fmt, ...) \
+      fprintf((level) >= FD_LOG_WARN ? stderr : stdout, prefix " " fmt "\n", ##__VA_ARGS__)
+#endif
+
+// 关闭的级别：调用位于 if (false) 中，格式串和参数仍做类型检查（也不会产生未使用变量的
+// 警告），但不求值，编译后不留下任何代码
+#define FD_LOG_DISABLED(level, fmt, ...) \
+    do { \
+        if (false) { \
+            FD_LOG(level, "", fmt, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#if FD_LOG_LEVEL <= FD_LOG_VERBOSE
+  #define LOGV(fmt, ...) FD_LOG(FD_LOG_VERBOSE, "[VERBOSE]", fmt, ##__VA_ARGS__)
+#else
+  #define LOGV(fmt, ...) FD_LOG_DISABLED(FD_LOG_VERBOSE, fmt, ##__VA_ARGS__)
+#endif
+
+#if FD_LOG_LEVEL <= FD_LOG_DEBUG
+  #define LOGD(fmt, ...) FD_LOG(FD_LOG_DEBUG, "[DEBUG]", fmt, ##__VA_ARGS__)
+#else
+  #define LOGD(fmt, ...) FD_LOG_DISABLED(FD_LOG_DEBUG, fmt, ##__VA_ARGS__)
+#endif
+
+#if FD_LOG_LEVEL <= FD_LOG_INFO
+  #define LOGI(fmt, ...) FD_LOG(FD_LOG_INFO, "[INFO]", fmt, ##__VA_ARGS__)
+#else
+  #define LOGI(fmt, ...) FD_LOG_DISABLED(FD_LOG_INFO, fmt, ##__VA_ARGS__)
+#endif
+
+#if FD_LOG_LEVEL <= FD_LOG_WARN
+  #define LOGW(fmt, ...) FD_LOG(FD_LOG_WARN, "[WARN]", fmt, ##__VA_ARGS__)
+#else
+  #define LOGW(fmt, ...) FD_LOG_DISABLED(FD_LOG_WARN, fmt, ##__VA_ARGS__)
+#endif
+
+#if FD_LOG_LEVEL <= FD_LOG_ERROR
+  #define LOGE(fmt, ...) FD_LOG(FD_LOG_ERROR, "[ERROR]", fmt, ##__VA_ARGS__)
+#else
+  #define LOGE(fmt, ...) FD_LOG_DISABLED(FD_LOG_ERROR, fmt, ##__VA_ARGS__)
+#endif
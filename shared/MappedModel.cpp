@@ -0,0 +1,51 @@
+#include "MappedModel.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace facebook::react {
+
+MappedModel::~MappedModel() {
+    unmap();
+}
+
+bool MappedModel::map(const std::string& path) {
+    unmap();
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后文件描述符不再需要
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    // 模型只会被顺序读取一次（解析 / 拷贝权重），提示内核预读
+    madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    data_ = data;
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedModel::unmap() {
+    if (data_) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+} // namespace facebook::react
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "ModelSource.h"
+
+namespace facebook::react {
+
+// 只读内存映射的模型文件
+// 映射的生命周期由调用方显式控制：map() 建立映射，unmap() 或析构时解除。
+// 数据由 page cache 提供，不占用堆内存，解除映射后内核可随时回收。
+class MappedModel : public ModelSource {
+public:
+    MappedModel() = default;
+    ~MappedModel();
+
+    MappedModel(const MappedModel&) = delete;
+    MappedModel& operator=(const MappedModel&) = delete;
+
+    // 映射整个文件，失败（文件不存在、不可读或为空）时返回 false
+    bool map(const std::string& path);
+    void unmap();
+
+    bool mapped() const { return data_ != nullptr; }
+    const void* data() const override { return data_; }
+    size_t size() const override { return size_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace facebook::react
@@ -0,0 +1,170 @@
+#include "ModelRegistry.h"
+#include "Log.h"
+
+#include <iterator>
+
+#define TAG "ModelRegistry"
+
+namespace facebook::react {
+
+namespace {
+
+// 两份参数加载出的检测器是否等价（open 回调不参与比较，同一 id 视为同一模型）。
+// 输入尺寸参与比较，尺寸不同即重新加载；只有双方都保留模型缓冲时例外，此时检测器
+// 可按 detect() 传入的尺寸创建 session。模型缓冲释放时需要同时保留多种尺寸的，
+// 应按尺寸用不同的 id 注册
+bool sameSpec(const ModelSpec& a, const ModelSpec& b) {
+    const DetectorOptions& x = a.options;
+    const DetectorOptions& y = b.options;
+    bool sameInput = (x.inputWidth == y.inputWidth && x.inputHeight == y.inputHeight) ||
+                     (!x.releaseModelAfterInit && !y.releaseModelAfterInit);
+    return x.numThreads == y.numThreads && x.precision == y.precision &&
+           x.memory == y.memory && x.power == y.power && sameInput &&
+           x.scoreThreshold == y.scoreThreshold && x.iouThreshold == y.iouThreshold &&
+           x.maxFaces == y.maxFaces && x.releaseModelAfterInit == y.releaseModelAfterInit &&
+           x.batchSizes == y.batchSizes && x.inputSizes == y.inputSizes &&
+           a.preprocess == b.preprocess && a.filter == b.filter &&
+           a.sessionCount == b.sessionCount && a.memoryBytes == b.memoryBytes;
+}
+
+} // namespace
+
+ModelRegistry::ModelRegistry(size_t budgetBytes) : budgetBytes_(budgetBytes) {}
+
+void ModelRegistry::setBudget(size_t budgetBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budgetBytes_ = budgetBytes;
+    trimLocked("");
+}
+
+void ModelRegistry::add(const std::string& id, ModelSpec spec) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = entries_.find(id);
+    if (it == entries_.end()) {
+        entries_[id].spec = std::move(spec);
+        return;
+    }
+    // 等待正在进行的加载结束，避免加载结果与新参数不一致
+    Entry& entry = it->second;
+    loadedCv_.wait(lock, [&entry] { return !entry.loading; });
+    if (entry.detector && sameSpec(entry.spec, spec)) {
+        entry.spec.open = std::move(spec.open);
+        return;
+    }
+    unloadLocked(entry);
+    entry.spec = std::move(spec);
+}
+
+bool ModelRegistry::contains(const std::string& id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.count(id) > 0;
+}
+
+std::shared_ptr<NativeFaceDetector> ModelRegistry::acquire(const std::string& id, int* error) {
+    if (error) *error = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = entries_.find(id);
+    if (it == entries_.end()) {
+        LOGE("Model not registered: %s", id.c_str());
+        if (error) *error = 10005;
+        return nullptr;
+    }
+
+    // 同一模型同时只有一个线程加载，其余线程等待加载结果
+    Entry& entry = it->second;
+    loadedCv_.wait(lock, [&entry] { return !entry.loading; });
+    if (entry.detector) {
+        lru_.splice(lru_.begin(), lru_, entry.lru);
+        ++hits_;
+        return entry.detector;
+    }
+
+    entry.loading = true;
+    ModelSpec spec = entry.spec;
+    lock.unlock();
+
+    auto detector = std::make_shared<NativeFaceDetector>();
+    detector->setSessionCount(spec.sessionCount);
+    detector->setPreprocess(spec.preprocess, spec.filter);
+    size_t bytes = spec.memoryBytes;
+    int ret = 10004;
+    if (std::unique_ptr<ModelSource> model = spec.open ? spec.open() : nullptr) {
+        ret = detector->init(*model, spec.options);
+        // 保留模型缓冲时解释器里还有一份拷贝
+        if (bytes == 0) bytes = model->size() * (spec.options.releaseModelAfterInit ? 1 : 2);
+    }
+
+    lock.lock();
+    entry.loading = false;
+    loadedCv_.notify_all();
+    if (ret != 0) {
+        LOGE("Failed to load model %s, error code: %d", id.c_str(), ret);
+        if (error) *error = ret;
+        return nullptr;
+    }
+
+    entry.detector = detector;
+    entry.bytes = bytes;
+    lru_.push_front(id);
+    entry.lru = lru_.begin();
+    residentBytes_ += bytes;
+    ++loads_;
+    LOGI("Loaded model %s (%zu KB, resident %zu KB)", id.c_str(), bytes / 1024,
+         residentBytes_ / 1024);
+    trimLocked(id);
+    return detector;
+}
+
+void ModelRegistry::evict(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(id);
+    if (it != entries_.end() && it->second.detector) {
+        unloadLocked(it->second);
+    }
+}
+
+void ModelRegistry::evictAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [id, entry] : entries_) {
+        if (entry.detector) unloadLocked(entry);
+    }
+}
+
+ModelRegistry::Stats ModelRegistry::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.budgetBytes = budgetBytes_;
+    stats.residentBytes = residentBytes_;
+    stats.loaded.assign(lru_.begin(), lru_.end());
+    stats.hits = hits_;
+    stats.loads = loads_;
+    stats.evictions = evictions_;
+    return stats;
+}
+
+void ModelRegistry::unloadLocked(Entry& entry) {
+    if (!entry.detector) return;
+    // 只释放注册表的引用，仍在使用该检测器的调用方结束后才真正析构
+    entry.detector.reset();
+    residentBytes_ -= entry.bytes;
+    entry.bytes = 0;
+    lru_.erase(entry.lru);
+    ++evictions_;
+}
+
+void ModelRegistry::trimLocked(const std::string& keep) {
+    if (budgetBytes_ == 0) return;
+    // 从最久未使用的开始淘汰；keep（刚加载的模型）即使单独超出预算也保留
+    auto it = lru_.end();
+    while (residentBytes_ > budgetBytes_ && it != lru_.begin()) {
+        --it;
+        if (*it == keep) continue;
+        Entry& entry = entries_[*it];
+        LOGI("Evicting model %s (%zu KB)", it->c_str(), entry.bytes / 1024);
+        // unloadLocked 会删除 *it，先把迭代器移到后一个位置
+        it = std::next(it);
+        unloadLocked(entry);
+    }
+}
+
+} // namespace facebook::react
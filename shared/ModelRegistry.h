@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ModelSource.h"
+#include "NativeFaceDetector.h"
+
+namespace facebook::react {
+
+// 注册到 ModelRegistry 的模型
+struct ModelSpec {
+    // 打开模型数据，返回 nullptr 表示模型不存在；只在加载期间持有
+    std::function<std::unique_ptr<ModelSource>()> open;
+    DetectorOptions options;
+    PreprocessMode preprocess = PreprocessMode::Fused;
+    MNN::CV::Filter filter = MNN::CV::BILINEAR;
+    int sessionCount = 1;
+    // 加载后的常驻内存估算（字节），0 表示按模型大小计：releaseModel() 之后
+    // 权重只存在于 backend 的常量张量中，是这类小模型常驻内存的主要部分；
+    // 保留模型缓冲时按两倍计
+    size_t memoryBytes = 0;
+};
+
+// 多模型注册表
+// - 按模型 id 注册，第一次 acquire() 时才加载（打开模型、init 检测器）
+// - 已加载的检测器由所有调用方共享，detect() 本身是线程安全的
+// - 常驻内存超过预算时按最近使用顺序淘汰；被淘汰的检测器在最后一个持有者释放后才真正析构
+// - 加载在锁外进行，加载一个模型时其他已加载的模型仍可正常 acquire()
+class ModelRegistry {
+public:
+    struct Stats {
+        size_t budgetBytes = 0;
+        size_t residentBytes = 0;
+        std::vector<std::string> loaded;  // 最近使用的在前
+        uint64_t hits = 0;
+        uint64_t loads = 0;
+        uint64_t evictions = 0;
+    };
+
+    // budgetBytes 为 0 表示不限制
+    explicit ModelRegistry(size_t budgetBytes = 0);
+
+    ModelRegistry(const ModelRegistry&) = delete;
+    ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+    // 修改内存预算，立即淘汰超出部分
+    void setBudget(size_t budgetBytes);
+
+    // 注册或更新模型；参数与已注册的相同时保留已加载的检测器，否则卸载旧实例
+    void add(const std::string& id, ModelSpec spec);
+    bool contains(const std::string& id) const;
+
+    // 返回 id 对应的检测器，未加载时加载。失败返回 nullptr 并把错误码写入 error：
+    // 10005 未注册，10004 模型无法打开，其余为 NativeFaceDetector::init() 的错误码
+    std::shared_ptr<NativeFaceDetector> acquire(const std::string& id, int* error = nullptr);
+
+    // 卸载一个 / 全部模型（注册信息保留，下次 acquire() 重新加载）
+    void evict(const std::string& id);
+    void evictAll();
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        ModelSpec spec;
+        std::shared_ptr<NativeFaceDetector> detector;
+        size_t bytes = 0;
+        bool loading = false;
+        std::list<std::string>::iterator lru;
+    };
+
+    // 以下函数调用方需持有 mutex_
+    void unloadLocked(Entry& entry);
+    void trimLocked(const std::string& keep);
+
+    mutable std::mutex mutex_;
+    std::condition_variable loadedCv_;
+    std::map<std::string, Entry> entries_;
+    std::list<std::string> lru_;  // 已加载的模型，最近使用的在前
+    size_t budgetBytes_;
+    size_t residentBytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t loads_ = 0;
+    uint64_t evictions_ = 0;
+};
+
+} // namespace facebook::react
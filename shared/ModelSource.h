@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace facebook::react {
+
+// 模型数据来源：一段完整 .mnn 内容的只读内存
+// NativeFaceDetector::init() 只在调用期间读取（createFromBuffer 会拷贝），返回后即可释放。
+class ModelSource {
+public:
+    virtual ~ModelSource() = default;
+
+    virtual const void* data() const = 0;
+    virtual size_t size() const = 0;
+
+    bool valid() const { return data() != nullptr && size() > 0; }
+};
+
+// 内存中的模型：持有一份拷贝，或只引用调用方保证在 init 期间有效的缓冲区
+// 桌面端用它在没有文件映射 / AAssetManager 的情况下走同一条 init(buffer) 路径。
+class MemoryModel : public ModelSource {
+public:
+    MemoryModel() = default;
+    MemoryModel(const void* data, size_t size) : data_(data), size_(size) {}
+    explicit MemoryModel(std::vector<uint8_t> bytes) { assign(std::move(bytes)); }
+
+    MemoryModel(const MemoryModel&) = delete;
+    MemoryModel& operator=(const MemoryModel&) = delete;
+
+    // 把整个文件读入内存，失败时返回 false
+    bool load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.good()) {
+            return false;
+        }
+        std::streamsize length = file.tellg();
+        if (length <= 0) {
+            return false;
+        }
+        std::vector<uint8_t> bytes(static_cast<size_t>(length));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(bytes.data()), length)) {
+            return false;
+        }
+        assign(std::move(bytes));
+        return true;
+    }
+
+    void assign(std::vector<uint8_t> bytes) {
+        bytes_ = std::move(bytes);
+        data_ = bytes_.data();
+        size_ = bytes_.size();
+    }
+
+    const void* data() const override { return data_; }
+    size_t size() const override { return size_; }
+
+private:
+    std::vector<uint8_t> bytes_;
+    const void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace facebook::react
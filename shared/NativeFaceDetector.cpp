@@ -1,47 +1,179 @@
 #include "NativeFaceDetector.h"
-
-// 平台特定的头文件和日志宏
-#ifdef __ANDROID__
-  #include <android/log.h>
-  #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
-  #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
-#else
-  #include <cstdio>
-  #define LOGI(fmt, ...) printf("[INFO] " fmt "\n", ##__VA_ARGS__)
-  #define LOGE(fmt, ...) fprintf(stderr, "[ERROR] " fmt "\n", ##__VA_ARGS__)
-#endif
+#include "MappedModel.h"
+#include "PerfStats.h"
+#include "Log.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <iostream>
+#include <iterator>
+#include <thread>
 
 #define TAG "NativeFaceDetector"
 
-// 使用 OpenCV 的 MAX/MIN 宏，不再重复定义
-#define Clip(x, y) (x < 0 ? 0 : (x > y ? y : x))
-
 namespace facebook::react {
 
+namespace {
+
+// 分段计时：lap() 返回距上一次 lap() 的毫秒数
+class StageClock {
+public:
+    StageClock() : start_(Clock::now()), last_(start_) {}
+
+    double lap() {
+        auto now = Clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - last_).count();
+        last_ = now;
+        return ms;
+    }
+
+    double total() const {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start_;
+    Clock::time_point last_;
+};
+
+// 把一次 detect() 的各阶段耗时记录到进程内的统计（getPerfStats）
+void recordProfile(const DetectProfile& stage) {
+    PerfStats& stats = sharedPerfStats();
+    stats.record(PerfStage::Resize, stage.resizeMs);
+    stats.record(PerfStage::Convert, stage.convertMs);
+    stats.record(PerfStage::Inference, stage.inferenceMs);
+    stats.record(PerfStage::OutputCopy, stage.copyMs);
+    stats.record(PerfStage::AnchorDecode, stage.decodeMs);
+    stats.record(PerfStage::Nms, stage.nmsMs);
+    stats.record(PerfStage::Detect, stage.totalMs);
+}
+
+// 320x240 输入使用编译期特化的解码器，其他尺寸走运行时生成 anchors 的通用路径
+using Rfb320Decoder = FixedDecoder<UltraFaceRfb320>;
+
+bool isRfb320Input(int width, int height) {
+    return width == Rfb320Decoder::kInputWidth && height == Rfb320Decoder::kInputHeight;
+}
+
+// 生成 UltraFace anchors
+void generateUltraFaceAnchors(int width, int height, AnchorTable* anchors) {
+    static const std::vector<std::vector<float>> kMinBoxes = [] {
+        std::vector<std::vector<float>> minBoxes(UltraFaceParams::kNumLevels);
+        for (int i = 0; i < UltraFaceParams::kNumLevels; ++i) {
+            minBoxes[i].assign(UltraFaceParams::kMinBoxes[i],
+                               UltraFaceParams::kMinBoxes[i] + UltraFaceParams::kNumMinBoxes[i]);
+        }
+        return minBoxes;
+    }();
+    static const std::vector<float> kStrides(std::begin(UltraFaceParams::kStrides),
+                                             std::end(UltraFaceParams::kStrides));
+    generateAnchors(width, height, kMinBoxes, kStrides, anchors);
+}
+
+// (源格式, 是否 letterbox) -> framePretreats 的键
+int pretreatKey(MNN::CV::ImageFormat format, bool letterbox) {
+    return static_cast<int>(format) * 2 + (letterbox ? 1 : 0);
+}
+
+} // namespace
+
 NativeFaceDetector::NativeFaceDetector()
     : initialized_(false)
-    , session_(nullptr)
-    , inputTensor_(nullptr) {
+    , modelReleased_(false)
+    , preprocessMode_(PreprocessMode::Fused)
+    , filter_(MNN::CV::BILINEAR)
+    , sessionCount_(1)
+    , inputSizeWidth_(options_.inputWidth)
+    , inputSizeHeight_(options_.inputHeight)
+    , scoreThreshold_(options_.scoreThreshold) {
 }
 
 NativeFaceDetector::~NativeFaceDetector() {
     if (interpreter_) {
         interpreter_->releaseModel();
-        interpreter_->releaseSession(session_);
+        releaseSessions();
     }
 }
 
-int NativeFaceDetector::init(const std::string& modelPath) {
-    LOGI("Start init NativeFaceDetector");
+void NativeFaceDetector::setSessionCount(int count) {
+    sessionCount_ = std::max(1, count);
+}
+
+void NativeFaceDetector::releaseSessions() {
+    for (auto& slot : slots_) {
+        for (auto& iter : slot->batchSessions) {
+            interpreter_->releaseSession(iter.second.session);
+        }
+        for (auto& iter : slot->sizedSessions) {
+            interpreter_->releaseSession(iter.second.session);
+        }
+        interpreter_->releaseSession(slot->session);
+    }
+    slots_.clear();
+    freeSlots_.clear();
+    std::lock_guard<std::mutex> lock(anchorsMutex_);
+    sizedAnchors_.clear();
+}
+
+int NativeFaceDetector::init(const std::string& modelPath, const DetectorOptions& options) {
     LOGI("Model path: %s", modelPath.c_str());
 
+    // 映射只在 init 期间存在：createFromBuffer 拷贝权重后即可解除
+    MappedModel model;
+    if (!model.map(modelPath)) {
+        LOGE("Failed to map model file: %s", modelPath.c_str());
+        return 10004;
+    }
+    int ret = init(model.data(), model.size(), options);
+    model.unmap();
+    return ret;
+}
+
+int NativeFaceDetector::init(const ModelSource& model, const DetectorOptions& options) {
+    if (!model.valid()) {
+        LOGE("Model source is empty");
+        return 10004;
+    }
+    return init(model.data(), model.size(), options);
+}
+
+int NativeFaceDetector::init(const void* buffer, size_t size, const DetectorOptions& options) {
+    LOGI("Start init NativeFaceDetector");
+    LOGI("Model size: %zu bytes", size);
+
+    if (options.numThreads < 1 || options.inputWidth < 2 || options.inputHeight < 2 ||
+        options.scoreThreshold < 0.0f || options.scoreThreshold >= 1.0f ||
+        options.iouThreshold <= 0.0f || options.iouThreshold > 1.0f || options.maxFaces < 0) {
+        LOGE("Invalid detector options");
+        return 10003;
+    }
+    for (int batch : options.batchSizes) {
+        if (batch < 1) {
+            LOGE("Invalid batch size: %d", batch);
+            return 10003;
+        }
+    }
+    for (const auto& [width, height] : options.inputSizes) {
+        if (width < 2 || height < 2) {
+            LOGE("Invalid input size: %dx%d", width, height);
+            return 10003;
+        }
+    }
+
+    // 重复 init 时先释放旧模型的 session
+    if (interpreter_) {
+        releaseSessions();
+    }
+    initialized_ = false;
+
     // 创建 MNN 解释器
     interpreter_ = std::shared_ptr<MNN::Interpreter>(
-        MNN::Interpreter::createFromFile(modelPath.c_str()));
+        MNN::Interpreter::createFromBuffer(buffer, size));
+    modelReleased_ = false;
+    releasedWarned_ = false;
 
     if (nullptr == interpreter_) {
         LOGE("Failed to load model");
@@ -49,122 +181,486 @@ int NativeFaceDetector::init(const std::string& modelPath) {
     }
 
     // 配置会话
-    MNN::ScheduleConfig scheduleConfig;
-    scheduleConfig.type = MNN_FORWARD_CPU;
-    scheduleConfig.numThread = 2;
-
-    MNN::BackendConfig backendConfig;
-    backendConfig.memory = MNN::BackendConfig::Memory_Normal;
-    backendConfig.power = MNN::BackendConfig::Power_Normal;
-    backendConfig.precision = MNN::BackendConfig::Precision_Normal;
-    scheduleConfig.backendConfig = &backendConfig;
+    options_ = options;
+    inputSizeWidth_ = options.inputWidth;
+    inputSizeHeight_ = options.inputHeight;
+    scoreThreshold_ = options.scoreThreshold;
+    nmsConfig_.iouThreshold = options.iouThreshold;
+    nmsConfig_.maxDetections = options.maxFaces;
 
-    // 创建会话
-    session_ = interpreter_->createSession(scheduleConfig);
+    scheduleConfig_.type = MNN_FORWARD_CPU;
+    scheduleConfig_.numThread = options.numThreads;
 
-    // 配置输入张量
-    inputTensor_ = interpreter_->getSessionInput(session_, nullptr);
-    interpreter_->resizeTensor(inputTensor_, {1, 3, inputSizeHeight_, inputSizeWidth_});
-    interpreter_->resizeSession(session_);
-
-    // 配置图像预处理
-    MNN::CV::Matrix trans;
-    trans.setScale(1.0f, 1.0f);
+    backendConfig_.memory = options.memory;
+    backendConfig_.power = options.power;
+    backendConfig_.precision = options.precision;
+    scheduleConfig_.backendConfig = &backendConfig_;
+    LOGI("Options: threads=%d, precision=%d, memory=%d, power=%d, input=%dx%d",
+         options.numThreads, options.precision, options.memory, options.power,
+         inputSizeWidth_, inputSizeHeight_);
 
-    MNN::CV::ImageProcess::Config imgConfig;
-    imgConfig.filterType = MNN::CV::BICUBIC;
-    memcpy(imgConfig.mean, meanVals_, sizeof(meanVals_));
-    memcpy(imgConfig.normal, normVals_, sizeof(normVals_));
-    imgConfig.sourceFormat = MNN::CV::BGR;
-    imgConfig.destFormat = MNN::CV::RGB;
+    // 创建 session 池，每个 session 配置自己的输入张量和图像预处理
+    for (int i = 0; i < sessionCount_; ++i) {
+        auto slot = std::make_unique<SessionSlot>();
+        slot->session = createSession(1, inputSizeWidth_, inputSizeHeight_, &slot->input);
+        slot->pretreat = createPretreat(MNN::CV::BGR);
+        freeSlots_.push_back(slot.get());
+        slots_.push_back(std::move(slot));
+    }
+    LOGI("Created %d sessions", sessionCount_);
 
-    pretreat_ = std::shared_ptr<MNN::CV::ImageProcess>(
-        MNN::CV::ImageProcess::create(imgConfig));
-    pretreat_->setMatrix(trans);
+    // 列出的输入尺寸和批大小在释放模型缓冲之前创建，每个 slot 一份
+    for (auto& slot : slots_) {
+        SizedSession sized;
+        for (const auto& [width, height] : options.inputSizes) {
+            getSizedSession(*slot, width, height, &sized);
+        }
+        for (int batch : options.batchSizes) {
+            getBatchSession(*slot, batch, inputSizeWidth_, inputSizeHeight_);
+            for (const auto& [width, height] : options.inputSizes) {
+                getBatchSession(*slot, batch, width, height);
+            }
+        }
+    }
 
     // 打印模型信息
+    MNN::Session* session = slots_.front()->session;
     LOGI("=== Model Info ===");
-    auto allInput = interpreter_->getSessionInputAll(session_);
+    auto allInput = interpreter_->getSessionInputAll(session);
     LOGI("Inputs: %zu", allInput.size());
     for (auto& iter : allInput) {
         LOGI("  Input name: %s", iter.first.c_str());
     }
 
-    auto allOutput = interpreter_->getSessionOutputAll(session_);
+    auto allOutput = interpreter_->getSessionOutputAll(session);
     LOGI("Outputs: %zu", allOutput.size());
     for (auto& iter : allOutput) {
         LOGI("  Output name: %s", iter.first.c_str());
     }
     LOGI("=================");
 
-    // 生成 anchors（来自 UltraFace）
-    std::vector<std::vector<float>> minBoxes = {
-        {10.0f, 16.0f, 24.0f},
-        {32.0f, 48.0f},
-        {64.0f, 96.0f},
-        {128.0f, 192.0f, 256.0f}
-    };
-    std::vector<float> strides = {8.0f, 16.0f, 32.0f, 64.0f};
-    generateAnchors(inputSizeWidth_, inputSizeHeight_, minBoxes, strides, &anchors_);
+    // session 已持有各自的权重，解释器里的模型缓冲不再需要
+    if (options.releaseModelAfterInit) {
+        interpreter_->releaseModel();
+        modelReleased_ = true;
+    }
+
+    // 生成 anchors（来自 UltraFace）；320x240 的 anchor 表在编译期生成
+    anchors_.clear();
+    if (isRfb320Input(inputSizeWidth_, inputSizeHeight_)) {
+        LOGI("Using compile-time anchors (%d)", Rfb320Decoder::kNumAnchors);
+    } else {
+        generateUltraFaceAnchors(inputSizeWidth_, inputSizeHeight_, &anchors_);
+        LOGI("Generated %zu anchors", anchors_.size());
+    }
 
     initialized_ = true;
     LOGI("NativeFaceDetector initialized successfully");
     return 0;
 }
 
-int NativeFaceDetector::detect(const cv::Mat& img, std::vector<FaceInfo>* faces) {
-    faces->clear();
+void NativeFaceDetector::setPreprocess(PreprocessMode mode, MNN::CV::Filter filter) {
+    preprocessMode_ = mode;
+    if (filter != filter_) {
+        filter_ = filter;
+        // 滤波器只能在创建 ImageProcess 时指定
+        for (auto& slot : slots_) {
+            slot->pretreat = createPretreat(MNN::CV::BGR);
+            slot->framePretreats.clear();
+        }
+    }
+}
 
-    if (!initialized_) {
-        LOGE("Model not initialized");
-        return 10000;
+std::shared_ptr<MNN::CV::ImageProcess> NativeFaceDetector::createPretreat(
+        MNN::CV::ImageFormat sourceFormat, bool letterbox) {
+    MNN::CV::ImageProcess::Config imgConfig;
+    imgConfig.filterType = filter_;
+    // letterbox 的边距落在原图之外，按 0 像素采样（归一化后约为 -1，即黑边）
+    imgConfig.wrap = letterbox ? MNN::CV::ZERO : MNN::CV::CLAMP_TO_EDGE;
+    memcpy(imgConfig.mean, UltraFaceParams::kMean, sizeof(UltraFaceParams::kMean));
+    memcpy(imgConfig.normal, UltraFaceParams::kNorm, sizeof(UltraFaceParams::kNorm));
+    imgConfig.sourceFormat = sourceFormat;
+    imgConfig.destFormat = MNN::CV::RGB;
+
+    return std::shared_ptr<MNN::CV::ImageProcess>(
+        MNN::CV::ImageProcess::create(imgConfig));
+}
+
+MNN::CV::ImageProcess* NativeFaceDetector::getPretreat(SessionSlot& slot,
+                                                       MNN::CV::ImageFormat format,
+                                                       bool letterbox) {
+    if (format == MNN::CV::BGR && !letterbox) {
+        return slot.pretreat.get();
+    }
+    auto& pretreat = slot.framePretreats[pretreatKey(format, letterbox)];
+    if (!pretreat) {
+        pretreat = createPretreat(format, letterbox);
     }
+    return pretreat.get();
+}
 
-    if (img.empty()) {
-        LOGE("Input image is empty");
-        return 10001;
+void NativeFaceDetector::setNms(const NmsConfig& config) {
+    nmsConfig_ = config;
+}
+
+MNN::Session* NativeFaceDetector::createSession(int batch, int width, int height,
+                                                MNN::Tensor** input) {
+    std::lock_guard<std::mutex> lock(interpreterMutex_);
+    MNN::Session* session = interpreter_->createSession(scheduleConfig_);
+    *input = interpreter_->getSessionInput(session, nullptr);
+    interpreter_->resizeTensor(*input, {batch, 3, height, width});
+    interpreter_->resizeSession(session);
+    return session;
+}
+
+bool NativeFaceDetector::computeGeometry(const InputConfig& input, int srcWidth, int srcHeight,
+                                         InputGeometry* geometry) const {
+    geometry->width = input.width > 0 ? input.width : inputSizeWidth_;
+    geometry->height = input.height > 0 ? input.height : inputSizeHeight_;
+    if (input.width < 0 || input.height < 0 || geometry->width < 2 || geometry->height < 2) {
+        LOGE("Invalid input size: %dx%d", input.width, input.height);
+        return false;
     }
+    geometry->letterbox = input.letterbox;
+    geometry->scale = 1.0f;
+    geometry->padX = 0.0f;
+    geometry->padY = 0.0f;
+    if (input.letterbox) {
+        geometry->scale = std::min(static_cast<float>(geometry->width) / srcWidth,
+                                   static_cast<float>(geometry->height) / srcHeight);
+        // 边距取整：ResizeThenConvert 的 copyMakeBorder 只能按整像素填充，
+        // 采样矩阵和解码使用同一个值，框才不会偏移
+        int contentWidth = std::max(1, static_cast<int>(std::lround(srcWidth * geometry->scale)));
+        int contentHeight = std::max(1, static_cast<int>(std::lround(srcHeight * geometry->scale)));
+        geometry->padX = static_cast<float>((geometry->width - contentWidth) / 2);
+        geometry->padY = static_cast<float>((geometry->height - contentHeight) / 2);
+    }
+    return true;
+}
 
-    int width = img.cols;
-    int height = img.rows;
+MNN::CV::Matrix NativeFaceDetector::sourceMatrix(const InputGeometry& geometry,
+                                                 int srcWidth, int srcHeight) {
+    // 与 cv::resize 相同的像素中心对齐：输入像素 x 的中心 x + 0.5 对应原图的
+    // (x + 0.5) / scale，再减 0.5 回到 ImageProcess 采样使用的整数像素坐标
+    MNN::CV::Matrix trans;
+    if (geometry.letterbox) {
+        // 输入坐标 (x, y) -> 原图 ((x - padX + 0.5) / scale - 0.5, ...)
+        trans.setTranslate(0.5f - geometry.padX, 0.5f - geometry.padY);
+        trans.postScale(1.0f / geometry.scale, 1.0f / geometry.scale);
+    } else {
+        trans.setScale(static_cast<float>(srcWidth) / geometry.width,
+                       static_cast<float>(srcHeight) / geometry.height);
+        trans.postTranslate(0.5f * srcWidth / geometry.width, 0.5f * srcHeight / geometry.height);
+    }
+    trans.postTranslate(-0.5f, -0.5f);
+    return trans;
+}
 
-    // 调整图像大小并预处理
-    cv::Mat imgResized;
-    cv::resize(img, imgResized, cv::Size(inputSizeWidth_, inputSizeHeight_));
-    pretreat_->convert(imgResized.data, inputSizeWidth_, inputSizeHeight_,
-                       imgResized.step[0], inputTensor_);
+bool NativeFaceDetector::getSizedSession(SessionSlot& slot, int width, int height,
+                                         SizedSession* sized) {
+    if (width == inputSizeWidth_ && height == inputSizeHeight_) {
+        sized->session = slot.session;
+        sized->input = slot.input;
+        return true;
+    }
+    auto iter = slot.sizedSessions.find({width, height});
+    if (iter != slot.sizedSessions.end()) {
+        *sized = iter->second;
+        return true;
+    }
+    if (modelReleased_) {
+        reportModelReleased("sized", 1, width, height);
+        return false;
+    }
 
-    // 运行推理
-    interpreter_->runSession(session_);
+    LOGI("Creating session for input %dx%d", width, height);
+    sized->session = createSession(1, width, height, &sized->input);
+    slot.sizedSessions.emplace(std::make_pair(width, height), *sized);
+    return true;
+}
+
+const AnchorTable& NativeFaceDetector::getAnchors(int width, int height) {
+    if (width == inputSizeWidth_ && height == inputSizeHeight_) {
+        return anchors_;
+    }
+    // map 的节点地址稳定，返回的引用在下次 init 前一直有效
+    std::lock_guard<std::mutex> lock(anchorsMutex_);
+    auto iter = sizedAnchors_.find({width, height});
+    if (iter == sizedAnchors_.end()) {
+        iter = sizedAnchors_.emplace(std::make_pair(width, height), AnchorTable()).first;
+        generateUltraFaceAnchors(width, height, &iter->second);
+        LOGI("Generated %zu anchors for input %dx%d", iter->second.size(), width, height);
+    }
+    return iter->second;
+}
+
+void NativeFaceDetector::reportModelReleased(const char* what, int batch, int width, int height) {
+    if (!releasedWarned_.exchange(true)) {
+        LOGW("Model buffer released, cannot create %s session (batch %d, input %dx%d); "
+             "list it in DetectorOptions::batchSizes / inputSizes", what, batch, width, height);
+    } else {
+        LOGD("No %s session for batch %d, input %dx%d", what, batch, width, height);
+    }
+}
 
+NativeFaceDetector::SessionSlot* NativeFaceDetector::acquireSlot() {
+    std::unique_lock<std::mutex> lock(poolMutex_);
+    poolCv_.wait(lock, [this] { return !freeSlots_.empty(); });
+    SessionSlot* slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    return slot;
+}
+
+void NativeFaceDetector::releaseSlot(SessionSlot* slot) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        freeSlots_.push_back(slot);
+    }
+    poolCv_.notify_one();
+}
+
+NativeFaceDetector::BatchSession* NativeFaceDetector::getBatchSession(SessionSlot& slot, int batch,
+                                                                      int width, int height) {
+    const auto key = std::make_tuple(batch, width, height);
+    auto iter = slot.batchSessions.find(key);
+    if (iter != slot.batchSessions.end()) {
+        return &iter->second;
+    }
+    if (modelReleased_) {
+        reportModelReleased("batch", batch, width, height);
+        return nullptr;
+    }
+
+    LOGI("Creating session for batch %d at %dx%d", batch, width, height);
+    BatchSession batchSession;
+    batchSession.session = createSession(batch, width, height, &batchSession.input);
+    batchSession.hostInput = std::make_shared<MNN::Tensor>(batchSession.input, MNN::Tensor::TENSORFLOW);
+    return &slot.batchSessions.emplace(key, batchSession).first->second;
+}
+
+const cv::Mat& NativeFaceDetector::prepareSource(MNN::CV::ImageProcess* pretreat,
+                                                 const InputGeometry& geometry,
+                                                 const cv::Mat& img, cv::Mat* resized) {
+    if (preprocessMode_ == PreprocessMode::Fused) {
+        // 矩阵把模型输入坐标映射回原图坐标，采样、BGR→RGB 和归一化在一次遍历中
+        // 直接写入输入张量，不产生中间 cv::Mat
+        pretreat->setMatrix(sourceMatrix(geometry, img.cols, img.rows));
+        return img;
+    }
+
+    if (geometry.letterbox) {
+        int contentWidth = std::max(1, static_cast<int>(std::lround(img.cols * geometry.scale)));
+        int contentHeight = std::max(1, static_cast<int>(std::lround(img.rows * geometry.scale)));
+        cv::Mat content;
+        cv::resize(img, content, cv::Size(contentWidth, contentHeight));
+        int left = static_cast<int>(geometry.padX);  // computeGeometry 已取整
+        int top = static_cast<int>(geometry.padY);
+        cv::copyMakeBorder(content, *resized, top, geometry.height - contentHeight - top,
+                           left, geometry.width - contentWidth - left,
+                           cv::BORDER_CONSTANT, cv::Scalar::all(0));
+    } else {
+        cv::resize(img, *resized, cv::Size(geometry.width, geometry.height));
+    }
+    MNN::CV::Matrix trans;
+    trans.setScale(1.0f, 1.0f);
+    pretreat->setMatrix(trans);
+    return *resized;
+}
+
+bool NativeFaceDetector::getOutputs(MNN::Session* session, MNN::Tensor** scores,
+                                    MNN::Tensor** boxes) {
     // 获取输出（参考实现使用硬编码的节点名称）
-    auto tensorScore = interpreter_->getSessionOutput(session_, "scores");
-    auto tensorBbox = interpreter_->getSessionOutput(session_, "boxes");
+    auto tensorScore = interpreter_->getSessionOutput(session, "scores");
+    auto tensorBbox = interpreter_->getSessionOutput(session, "boxes");
 
     // 如果找不到，尝试按顺序获取
     if (!tensorScore || !tensorBbox) {
-        LOGI("Named outputs not found, trying by index");
-        auto allOutput = interpreter_->getSessionOutputAll(session_);
-        LOGI("Total outputs: %zu", allOutput.size());
+        LOGD("Named outputs not found, trying by index");
+        auto allOutput = interpreter_->getSessionOutputAll(session);
+        LOGD("Total outputs: %zu", allOutput.size());
 
         int outputIdx = 0;
         for (auto& iter : allOutput) {
-            LOGI("Output[%d]: name=%s", outputIdx, iter.first.c_str());
+            LOGV("Output[%d]: name=%s", outputIdx, iter.first.c_str());
             if (outputIdx == 0 && !tensorBbox) {
                 tensorBbox = iter.second;
-                LOGI("Using output '%s' as bbox (fallback)", iter.first.c_str());
+                LOGD("Using output '%s' as bbox (fallback)", iter.first.c_str());
             } else if (outputIdx == 1 && !tensorScore) {
                 tensorScore = iter.second;
-                LOGI("Using output '%s' as score (fallback)", iter.first.c_str());
+                LOGD("Using output '%s' as score (fallback)", iter.first.c_str());
             }
             outputIdx++;
         }
     } else {
-        LOGI("Using named outputs: scores=%p, boxes=%p", tensorScore, tensorBbox);
+        LOGV("Using named outputs: scores=%p, boxes=%p", tensorScore, tensorBbox);
     }
 
     if (!tensorScore || !tensorBbox) {
         LOGE("Failed to get output tensors: score=%p, bbox=%p", tensorScore, tensorBbox);
+        return false;
+    }
+    *scores = tensorScore;
+    *boxes = tensorBbox;
+    return true;
+}
+
+void NativeFaceDetector::decodeOutputs(SessionSlot& slot, const InputGeometry& geometry, const float* scoreData,
+                                       const float* bboxData, int width, int height,
+                                       std::vector<FaceInfo>* faces,
+                                       double* decodeMs, double* nmsMs) {
+    StageClock clock;
+
+    const bool fixed = isRfb320Input(geometry.width, geometry.height);
+    const AnchorTable* anchors = fixed ? nullptr : &getAnchors(geometry.width, geometry.height);
+
+    // 解析结果：先向量化筛选分数超过阈值的 anchor，只对候选解码
+    if (fixed) {
+        Rfb320Decoder::select(scoreData, scoreThreshold_, &slot.candidates);
+    } else {
+        selectCandidates(scoreData, static_cast<int>(anchors->size()), scoreThreshold_,
+                         &slot.candidates);
+    }
+
+    // letterbox 时先解码到整个输入画布（以原图像素为单位），再减去边距
+    DecodeParams decodeParams;
+    decodeParams.scoreThreshold = scoreThreshold_;
+    decodeParams.imageWidth = width;
+    decodeParams.imageHeight = height;
+    if (geometry.letterbox) {
+        decodeParams.imageWidth = static_cast<int>(std::lround(geometry.width / geometry.scale));
+        decodeParams.imageHeight = static_cast<int>(std::lround(geometry.height / geometry.scale));
+    }
+    slot.facesTmp.clear();
+    if (fixed) {
+        Rfb320Decoder::decode(scoreData, bboxData, slot.candidates, decodeParams, &slot.facesTmp);
+    } else {
+        decodeCandidates(scoreData, bboxData, *anchors, slot.candidates, decodeParams,
+                         &slot.facesTmp);
+    }
+    if (geometry.letterbox) {
+        const float offsetX = geometry.padX / geometry.scale;
+        const float offsetY = geometry.padY / geometry.scale;
+        for (FaceInfo& face : slot.facesTmp) {
+            face.x = std::min(std::max(face.x - offsetX, 0.0f), std::max(0.0f, width - face.width));
+            face.y = std::min(std::max(face.y - offsetY, 0.0f), std::max(0.0f, height - face.height));
+        }
+    }
+    if (decodeMs) *decodeMs = clock.lap();
+
+    // NMS 去重
+    slot.nms.run(slot.facesTmp, nmsConfig_, faces);
+    if (nmsMs) *nmsMs = clock.lap();
+}
+
+int NativeFaceDetector::detect(const cv::Mat& img, std::vector<FaceInfo>* faces,
+                               DetectProfile* profile, const InputConfig& input) {
+    StageClock clock;
+    DetectProfile stage;
+    faces->clear();
+
+    if (!initialized_) {
+        LOGE("Model not initialized");
+        return 10000;
+    }
+
+    if (img.empty()) {
+        LOGE("Input image is empty");
+        return 10001;
+    }
+
+    InputGeometry geometry;
+    if (!computeGeometry(input, img.cols, img.rows, &geometry)) {
+        return 10003;
+    }
+
+    SlotLease lease(this);
+    SessionSlot& slot = *lease;
+    SizedSession sized;
+    if (!getSizedSession(slot, geometry.width, geometry.height, &sized)) {
+        return 10000;
+    }
+
+    // 调整图像大小并预处理
+    MNN::CV::ImageProcess* pretreat = getPretreat(slot, MNN::CV::BGR,
+        geometry.letterbox && preprocessMode_ == PreprocessMode::Fused);
+    cv::Mat imgResized;
+    const cv::Mat& src = prepareSource(pretreat, geometry, img, &imgResized);
+    stage.resizeMs = clock.lap();
+    pretreat->convert(src.data, src.cols, src.rows, src.step[0], sized.input);
+    stage.convertMs = clock.lap();
+
+    int ret = runDetection(slot, sized.session, geometry, img.cols, img.rows, faces, &stage);
+    if (ret != 0) {
+        return ret;
+    }
+    stage.totalMs = clock.total();
+    recordProfile(stage);
+    if (profile) {
+        *profile = stage;
+    }
+    return 0;
+}
+
+int NativeFaceDetector::detect(const PixelBuffer& frame, std::vector<FaceInfo>* faces,
+                               DetectProfile* profile, const InputConfig& input) {
+    StageClock clock;
+    DetectProfile stage;
+    faces->clear();
+
+    if (!initialized_) {
+        LOGE("Model not initialized");
+        return 10000;
+    }
+
+    if (!frame.data || frame.width <= 0 || frame.height <= 0) {
+        LOGE("Input frame is empty");
+        return 10001;
+    }
+
+    InputGeometry geometry;
+    if (!computeGeometry(input, frame.width, frame.height, &geometry)) {
+        return 10003;
+    }
+
+    SlotLease lease(this);
+    SessionSlot& slot = *lease;
+    SizedSession sized;
+    if (!getSizedSession(slot, geometry.width, geometry.height, &sized)) {
+        return 10000;
+    }
+
+    // 每种源格式一个 ImageProcess，采样矩阵与 Fused 模式相同
+    MNN::CV::ImageProcess* pretreat = getPretreat(slot, frame.format, geometry.letterbox);
+    pretreat->setMatrix(sourceMatrix(geometry, frame.width, frame.height));
+    stage.resizeMs = clock.lap();
+    pretreat->convert(frame.data, frame.width, frame.height, frame.stride, sized.input);
+    stage.convertMs = clock.lap();
+
+    int ret = runDetection(slot, sized.session, geometry, frame.width, frame.height, faces,
+                           &stage);
+    if (ret != 0) {
+        return ret;
+    }
+    stage.totalMs = clock.total();
+    recordProfile(stage);
+    if (profile) {
+        *profile = stage;
+    }
+    return 0;
+}
+
+int NativeFaceDetector::runDetection(SessionSlot& slot, MNN::Session* session,
+                                     const InputGeometry& geometry, int width, int height,
+                                     std::vector<FaceInfo>* faces, DetectProfile* stage) {
+    StageClock clock;
+
+    // 运行推理
+    runSession(session);
+    stage->inferenceMs = clock.lap();
+
+    MNN::Tensor* tensorScore = nullptr;
+    MNN::Tensor* tensorBbox = nullptr;
+    if (!getOutputs(session, &tensorScore, &tensorBbox)) {
         return 10002;
     }
 
@@ -172,155 +668,601 @@ int NativeFaceDetector::detect(const cv::Mat& img, std::vector<FaceInfo>* faces)
     MNN::Tensor hostBbox(tensorBbox, tensorBbox->getDimensionType());
     tensorScore->copyToHostTensor(&hostScore);
     tensorBbox->copyToHostTensor(&hostBbox);
+    stage->copyMs = clock.lap();
 
-    // 打印前几个score值（调试用）
-    const float* scoreData = hostScore.host<float>();
-    LOGI("First 5 score pairs (bg, face): %.3f,%.3f | %.3f,%.3f | %.3f,%.3f | %.3f,%.3f | %.3f,%.3f",
-         scoreData[0], scoreData[1], scoreData[2], scoreData[3], scoreData[4], scoreData[5],
-         scoreData[6], scoreData[7], scoreData[8], scoreData[9]);
+    decodeOutputs(slot, geometry, hostScore.host<float>(), hostBbox.host<float>(), width, height,
+                  faces, &stage->decodeMs, &stage->nmsMs);
 
-    // 解析结果
-    int numAnchors = static_cast<int>(anchors_.size());
-    std::vector<FaceInfo> facesTmp;
+    LOGD("Detected %zu faces", faces->size());
+    return 0;
+}
 
-    const float centerVariance = 0.1f;
-    const float sizeVariance = 0.2f;
+void NativeFaceDetector::runSession(MNN::Session* session) {
+    if (opProfiling_) {
+        opProfiler_.run(*interpreter_, session);
+    } else {
+        interpreter_->runSession(session);
+    }
+}
 
-    for (int i = 0; i < numAnchors; ++i) {
-        float score = hostScore.host<float>()[2 * i + 1];
-        if (score <= scoreThreshold_) continue;
+void NativeFaceDetector::setOpProfiling(bool enabled) {
+    if (enabled && !opProfiling_) {
+        opProfiler_.reset();
+    }
+    opProfiling_ = enabled;
+}
 
-        FaceInfo faceInfo;
+bool NativeFaceDetector::supportsBatch(int batch) const {
+    if (!initialized_ || batch < 1) {
+        return false;
+    }
+    return !modelReleased_ ||
+           std::find(options_.batchSizes.begin(), options_.batchSizes.end(), batch) !=
+               options_.batchSizes.end();
+}
 
-        // 计算边界框
-        float centerX = hostBbox.host<float>()[4 * i] * centerVariance * anchors_[i][2] + anchors_[i][0];
-        float centerY = hostBbox.host<float>()[4 * i + 1] * centerVariance * anchors_[i][3] + anchors_[i][1];
-        float centerW = exp(hostBbox.host<float>()[4 * i + 2] * sizeVariance) * anchors_[i][2];
-        float centerH = exp(hostBbox.host<float>()[4 * i + 3] * sizeVariance) * anchors_[i][3];
+int NativeFaceDetector::detectBatch(const std::vector<cv::Mat>& imgs,
+                                    std::vector<std::vector<FaceInfo>>* faces) {
+    faces->clear();
 
-        cv::Rect face;
-        face.x = static_cast<int>(Clip(centerX - centerW / 2.0f, 1.0f) * width);
-        face.y = static_cast<int>(Clip(centerY - centerH / 2.0f, 1.0f) * height);
-        face.width = static_cast<int>(Clip(centerW, 1.0f) * width);
-        face.height = static_cast<int>(Clip(centerH, 1.0f) * height);
+    if (!initialized_) {
+        LOGE("Model not initialized");
+        return 10000;
+    }
+
+    if (imgs.empty()) {
+        return 0;
+    }
+    for (const auto& img : imgs) {
+        if (img.empty()) {
+            LOGE("Input image is empty");
+            return 10001;
+        }
+    }
 
-        // 转换为正方形
-        int maxSide = MAX(face.width, face.height);
-        faceInfo.x = face.x + 0.5f * face.width - 0.5f * maxSide;
-        faceInfo.y = face.y + 0.5f * face.height - 0.5f * maxSide;
-        faceInfo.width = maxSide;
-        faceInfo.height = maxSide;
-        faceInfo.x = Clip(faceInfo.x, width - maxSide);
-        faceInfo.y = Clip(faceInfo.y, height - maxSide);
+    SlotLease lease(this);
+    SessionSlot& slot = *lease;
 
-        faceInfo.score = Clip(score, 1.0f);
-        facesTmp.push_back(faceInfo);
+    const int batch = static_cast<int>(imgs.size());
+    cv::Mat imgResized;
+    InputGeometry geometry;
+    computeGeometry(InputConfig(), 0, 0, &geometry);
+    BatchSession* batchSession = getBatchSession(slot, batch, inputSizeWidth_, inputSizeHeight_);
+    if (!batchSession) {
+        // 无法创建该批大小的 session：逐张用默认 session 推理，结果相同
+        faces->resize(batch);
+        for (int b = 0; b < batch; ++b) {
+            const cv::Mat& src = prepareSource(slot.pretreat.get(), geometry, imgs[b], &imgResized);
+            slot.pretreat->convert(src.data, src.cols, src.rows, src.step[0], slot.input);
+            DetectProfile stage;
+            int ret = runDetection(slot, slot.session, geometry, imgs[b].cols, imgs[b].rows,
+                                   &(*faces)[b], &stage);
+            if (ret != 0) {
+                faces->clear();
+                return ret;
+            }
+        }
+        return 0;
     }
 
-    // NMS 去重
-    nms(facesTmp, faces, iouThreshold_);
+    // 逐图预处理到 NHWC host 张量中各自的切片，再一次性拷贝到输入张量
+    const size_t planeSize = static_cast<size_t>(inputSizeWidth_) * inputSizeHeight_ * 3;
+    float* hostData = batchSession->hostInput->host<float>();
+    for (int b = 0; b < batch; ++b) {
+        const cv::Mat& src = prepareSource(slot.pretreat.get(), geometry, imgs[b], &imgResized);
+        slot.pretreat->convert(src.data, src.cols, src.rows, src.step[0],
+                           hostData + b * planeSize, inputSizeWidth_, inputSizeHeight_, 3);
+    }
+    batchSession->input->copyFromHostTensor(batchSession->hostInput.get());
+
+    // 运行推理
+    runSession(batchSession->session);
+
+    MNN::Tensor* tensorScore = nullptr;
+    MNN::Tensor* tensorBbox = nullptr;
+    if (!getOutputs(batchSession->session, &tensorScore, &tensorBbox)) {
+        return 10002;
+    }
+
+    MNN::Tensor hostScore(tensorScore, tensorScore->getDimensionType());
+    MNN::Tensor hostBbox(tensorBbox, tensorBbox->getDimensionType());
+    tensorScore->copyToHostTensor(&hostScore);
+    tensorBbox->copyToHostTensor(&hostBbox);
 
-    LOGI("Detected %zu faces", faces->size());
+    // 每个 batch 元素的 scores / boxes 各自独立解码
+    const size_t numAnchors = hostScore.elementSize() / (2 * batch);
+    faces->resize(batch);
+    for (int b = 0; b < batch; ++b) {
+        decodeOutputs(slot, geometry, hostScore.host<float>() + b * numAnchors * 2,
+                      hostBbox.host<float>() + b * numAnchors * 4,
+                      imgs[b].cols, imgs[b].rows, &(*faces)[b], nullptr, nullptr);
+    }
+
+    LOGD("Batch of %d images processed", batch);
     return 0;
 }
 
-// 生成 anchors
-int NativeFaceDetector::generateAnchors(
-    const int& width, const int& height,
-    const std::vector<std::vector<float>>& minBoxes,
-    const std::vector<float>& strides,
-    std::vector<std::vector<float>>* anchors) {
-
-    anchors->clear();
-    int numStrides = static_cast<int>(strides.size());
-
-    for (int i = 0; i < numStrides; ++i) {
-        auto stride = strides[i];
-
-        int numX = ceil(width / stride);
-        int numY = ceil(height / stride);
-
-        for (int y = 0; y < numY; ++y) {
-            for (int x = 0; x < numX; ++x) {
-                float centerX = (x + 0.5f) * stride / width;
-                float centerY = (y + 0.5f) * stride / height;
-
-                for (auto minBox : minBoxes[i]) {
-                    float centerW = minBox / width;
-                    float centerH = minBox / height;
-                    anchors->push_back({
-                        Clip(centerX, 1.0f),
-                        Clip(centerY, 1.0f),
-                        Clip(centerW, 1.0f),
-                        Clip(centerH, 1.0f)
-                    });
+int NativeFaceDetector::detectInRegions(const cv::Mat& img, const std::vector<FaceInfo>& regions,
+                                        std::vector<FaceInfo>* faces, const RegionConfig& config,
+                                        DetectProfile* profile, const InputConfig& input) {
+    faces->clear();
+
+    if (!initialized_) {
+        LOGE("Model not initialized");
+        return 10000;
+    }
+
+    if (img.empty()) {
+        LOGE("Input image is empty");
+        return 10001;
+    }
+
+    InputGeometry geometry;
+    if (config.expand <= 0 || config.maxRegions < 1) {
+        LOGE("Invalid region config");
+        return 10003;
+    }
+    if (!computeGeometry(input, img.cols, img.rows, &geometry)) {
+        return 10003;
+    }
+
+    std::vector<cv::Rect> rects = regionRects(regions, img.cols, img.rows, config, geometry);
+    if (rects.empty()) {
+        return 0;
+    }
+
+    return runRegions(rects, input, [&](SessionSlot& slot, const cv::Rect& rect,
+                                        const InputGeometry& regionGeometry, cv::Mat* resized) {
+        return matRegionSource(slot, img, rect, regionGeometry, resized);
+    }, faces, profile);
+}
+
+int NativeFaceDetector::detectInRegions(const PixelBuffer& frame,
+                                        const std::vector<FaceInfo>& regions,
+                                        std::vector<FaceInfo>* faces, const RegionConfig& config,
+                                        DetectProfile* profile, const InputConfig& input) {
+    faces->clear();
+
+    if (!initialized_) {
+        LOGE("Model not initialized");
+        return 10000;
+    }
+
+    if (!frame.data || frame.width <= 0 || frame.height <= 0) {
+        LOGE("Input frame is empty");
+        return 10001;
+    }
+
+    InputGeometry geometry;
+    if (config.expand <= 0 || config.maxRegions < 1) {
+        LOGE("Invalid region config");
+        return 10003;
+    }
+    if (!computeGeometry(input, frame.width, frame.height, &geometry)) {
+        return 10003;
+    }
+
+    std::vector<cv::Rect> rects = regionRects(regions, frame.width, frame.height, config,
+                                              geometry);
+    if (rects.empty()) {
+        return 0;
+    }
+
+    return runRegions(rects, input, [&](SessionSlot& slot, const cv::Rect& rect,
+                                        const InputGeometry& regionGeometry, cv::Mat*) {
+        // 按区域大小的采样矩阵平移到区域左上角，只采样该区域
+        MNN::CV::ImageProcess* pretreat = getPretreat(slot, frame.format, regionGeometry.letterbox);
+        MNN::CV::Matrix trans = sourceMatrix(regionGeometry, rect.width, rect.height);
+        trans.postTranslate(static_cast<float>(rect.x), static_cast<float>(rect.y));
+        pretreat->setMatrix(trans);
+        RegionSource source;
+        source.pretreat = pretreat;
+        source.data = frame.data;
+        source.width = frame.width;
+        source.height = frame.height;
+        source.stride = frame.stride;
+        return source;
+    }, faces, profile);
+}
+
+std::vector<cv::Rect> NativeFaceDetector::regionRects(const std::vector<FaceInfo>& regions,
+                                                      int srcWidth, int srcHeight,
+                                                      const RegionConfig& config,
+                                                      const InputGeometry& geometry) const {
+    std::vector<const FaceInfo*> order;
+    for (const FaceInfo& face : regions) {
+        if (face.width > 0 && face.height > 0) {
+            order.push_back(&face);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [](const FaceInfo* a, const FaceInfo* b) {
+        return a->score > b->score;
+    });
+
+    // 区域与模型输入宽高比相同，送入模型时不变形（贴边裁剪时除外）
+    const float aspect = static_cast<float>(geometry.width) / geometry.height;
+    const float maxWidth = static_cast<float>(srcWidth);
+    const float maxHeight = static_cast<float>(srcHeight);
+    // 以 (cx, cy) 为中心、不超过画面大小的区域；超出画面时整体平移回画面内，而不是裁掉一侧
+    auto place = [&](float cx, float cy, float width, float height) {
+        width = std::min(width, maxWidth);
+        height = std::min(height, maxHeight);
+        float x = std::min(std::max(cx - 0.5f * width, 0.0f), maxWidth - width);
+        float y = std::min(std::max(cy - 0.5f * height, 0.0f), maxHeight - height);
+        return cv::Rect2f(x, y, width, height);
+    };
+    std::vector<cv::Rect2f> expanded;
+    for (const FaceInfo* face : order) {
+        float side = std::max(face->width, face->height) * config.expand;
+        expanded.push_back(place(face->x + 0.5f * face->width, face->y + 0.5f * face->height,
+                                 aspect >= 1.0f ? side * aspect : side,
+                                 aspect >= 1.0f ? side : side / aspect));
+    }
+
+    // 重叠较多的区域合并，避免同一片像素推理两次；合并后重新检查
+    for (size_t i = 0; i < expanded.size(); ++i) {
+        for (size_t j = i + 1; j < expanded.size();) {
+            float inter = (expanded[i] & expanded[j]).area();
+            float iou = inter / (expanded[i].area() + expanded[j].area() - inter);
+            if (iou > config.mergeIoU) {
+                expanded[i] |= expanded[j];
+                expanded.erase(expanded.begin() + j);
+                j = i + 1;
+            } else {
+                ++j;
+            }
+        }
+    }
+    if (expanded.size() > static_cast<size_t>(config.maxRegions)) {
+        expanded.resize(config.maxRegions);
+    }
+    if (geometry.letterbox) {
+        // 合并出的外接矩形宽高比任意，补边会采样到区域外的真实像素
+        for (cv::Rect2f& region : expanded) {
+            region = place(region.x + 0.5f * region.width, region.y + 0.5f * region.height,
+                           std::max(region.width, region.height * aspect),
+                           std::max(region.height, region.width / aspect));
+        }
+    }
+
+    std::vector<cv::Rect> rects;
+    const cv::Rect bounds(0, 0, srcWidth, srcHeight);
+    for (const cv::Rect2f& region : expanded) {
+        int left = static_cast<int>(std::floor(region.x));
+        int top = static_cast<int>(std::floor(region.y));
+        int right = static_cast<int>(std::ceil(region.x + region.width));
+        int bottom = static_cast<int>(std::ceil(region.y + region.height));
+        cv::Rect rect = cv::Rect(left, top, right - left, bottom - top) & bounds;
+        if (rect.width >= 2 && rect.height >= 2) {
+            rects.push_back(rect);
+        }
+    }
+    return rects;
+}
+
+NativeFaceDetector::RegionSource NativeFaceDetector::matRegionSource(SessionSlot& slot,
+                                                                    const cv::Mat& img,
+                                                                    const cv::Rect& rect,
+                                                                    const InputGeometry& geometry,
+                                                                    cv::Mat* resized) {
+    // 子矩阵只是原图的视图，Fused 模式下直接从原图采样该区域
+    MNN::CV::ImageProcess* pretreat = getPretreat(slot, MNN::CV::BGR,
+        geometry.letterbox && preprocessMode_ == PreprocessMode::Fused);
+    cv::Mat view = img(rect);
+    const cv::Mat& src = prepareSource(pretreat, geometry, view, resized);
+    RegionSource source;
+    source.pretreat = pretreat;
+    source.data = src.data;
+    source.width = src.cols;
+    source.height = src.rows;
+    source.stride = static_cast<int>(src.step[0]);
+    return source;
+}
+
+template <typename PrepareFn, typename EmitFn>
+int NativeFaceDetector::inferRegions(SessionSlot& slot, const cv::Rect* rects, int count,
+                                     const InputConfig& input, PrepareFn& prepare, EmitFn& emit,
+                                     DetectProfile* stage) {
+    StageClock clock;
+    // 输入尺寸对所有区域相同，letterbox 的缩放和边距按各区域自己的宽高计算
+    std::vector<InputGeometry>& geometries = slot.regionGeometries;
+    geometries.resize(count);
+    for (int b = 0; b < count; ++b) {
+        if (!computeGeometry(input, rects[b].width, rects[b].height, &geometries[b])) {
+            return 10003;
+        }
+    }
+    const int width = geometries[0].width;
+    const int height = geometries[0].height;
+
+    // 单个区域直接写入该尺寸单图 session 的输入张量；多个区域逐个写入 NHWC host 张量中
+    // 各自的切片，再一次性拷贝到批量 session 的输入张量
+    MNN::Session* session = nullptr;
+    cv::Mat resized;
+    if (count == 1) {
+        SizedSession sized;
+        if (!getSizedSession(slot, width, height, &sized)) {
+            return 10000;
+        }
+        RegionSource source = prepare(slot, rects[0], geometries[0], &resized);
+        source.pretreat->convert(source.data, source.width, source.height, source.stride,
+                                 sized.input);
+        session = sized.session;
+    } else {
+        BatchSession* batchSession = getBatchSession(slot, count, width, height);
+        if (!batchSession) {
+            // 模型缓冲已释放，无法创建该批大小的 session
+            for (int b = 0; b < count; ++b) {
+                int ret = inferRegions(slot, rects + b, 1, input, prepare, emit, stage);
+                if (ret != 0) {
+                    return ret;
                 }
             }
+            return 0;
+        }
+        const size_t planeSize = static_cast<size_t>(width) * height * 3;
+        float* hostData = batchSession->hostInput->host<float>();
+        for (int b = 0; b < count; ++b) {
+            RegionSource source = prepare(slot, rects[b], geometries[b], &resized);
+            source.pretreat->convert(source.data, source.width, source.height, source.stride,
+                                     hostData + b * planeSize, width, height, 3);
+        }
+        batchSession->input->copyFromHostTensor(batchSession->hostInput.get());
+        session = batchSession->session;
+    }
+    stage->convertMs += clock.lap();
+
+    runSession(session);
+    stage->inferenceMs += clock.lap();
+
+    MNN::Tensor* tensorScore = nullptr;
+    MNN::Tensor* tensorBbox = nullptr;
+    if (!getOutputs(session, &tensorScore, &tensorBbox)) {
+        return 10002;
+    }
+
+    MNN::Tensor hostScore(tensorScore, tensorScore->getDimensionType());
+    MNN::Tensor hostBbox(tensorBbox, tensorBbox->getDimensionType());
+    tensorScore->copyToHostTensor(&hostScore);
+    tensorBbox->copyToHostTensor(&hostBbox);
+    stage->copyMs += clock.lap();
+
+    // 每个区域各自解码（坐标相对于区域），平移回原图
+    const size_t numAnchors = hostScore.elementSize() / (2 * count);
+    for (int b = 0; b < count; ++b) {
+        double decodeMs = 0;
+        double nmsMs = 0;
+        decodeOutputs(slot, geometries[b], hostScore.host<float>() + b * numAnchors * 2,
+                      hostBbox.host<float>() + b * numAnchors * 4,
+                      rects[b].width, rects[b].height, &slot.regionFaces, &decodeMs, &nmsMs);
+        stage->decodeMs += decodeMs;
+        stage->nmsMs += nmsMs;
+        for (FaceInfo face : slot.regionFaces) {
+            face.x += rects[b].x;
+            face.y += rects[b].y;
+            emit(rects[b], geometries[b], face);
         }
     }
+    return 0;
+}
+
+template <typename PrepareFn>
+int NativeFaceDetector::runRegions(const std::vector<cv::Rect>& rects, const InputConfig& input,
+                                   PrepareFn&& prepare, std::vector<FaceInfo>* faces,
+                                   DetectProfile* profile) {
+    StageClock clock;
+    DetectProfile stage;
 
-    LOGI("Generated %zu anchors", anchors->size());
+    SlotLease lease(this);
+    SessionSlot& slot = *lease;
+    slot.allRegionFaces.clear();
+    auto emit = [&slot](const cv::Rect&, const InputGeometry&, const FaceInfo& face) {
+        slot.allRegionFaces.push_back(face);
+    };
+    int ret = inferRegions(slot, rects.data(), static_cast<int>(rects.size()), input, prepare,
+                           emit, &stage);
+    if (ret != 0) {
+        return ret;
+    }
+    clock.lap();
+
+    // 相邻区域重叠部分的同一张脸会被检测多次，跨区域再做一次 NMS
+    slot.nms.run(slot.allRegionFaces, nmsConfig_, faces);
+    stage.nmsMs += clock.lap();
+    stage.totalMs = clock.total();
+    if (profile) {
+        *profile = stage;
+    }
     return 0;
 }
 
-// NMS 去重
-void NativeFaceDetector::nms(
-    const std::vector<FaceInfo>& inputs,
-    std::vector<FaceInfo>* result,
-    const float& threshold) {
+std::vector<cv::Rect> NativeFaceDetector::tileRects(int srcWidth, int srcHeight,
+                                                    const TileConfig& config,
+                                                    const InputConfig& input) const {
+    InputGeometry geometry;
+    if (!computeGeometry(input, srcWidth, srcHeight, &geometry)) {
+        return {};
+    }
 
-    result->clear();
-    if (inputs.size() == 0) return;
+    // 一个方向上的 tile 起点：首尾贴边，中间均匀分布，相邻 tile 至少重叠 overlap
+    auto positions = [&config](int length, int tile) {
+        std::vector<int> starts;
+        if (length <= tile) {
+            starts.push_back(0);
+            return starts;
+        }
+        float step = tile * (1.0f - config.overlap);
+        int n = static_cast<int>(std::ceil((length - tile) / step)) + 1;
+        for (int i = 0; i < n; ++i) {
+            starts.push_back(static_cast<int>(std::lround(static_cast<double>(i) * (length - tile) / (n - 1))));
+        }
+        return starts;
+    };
+
+    const int tileWidth = std::min(srcWidth, std::max(2, static_cast<int>(std::lround(geometry.width * config.tileScale))));
+    const int tileHeight = std::min(srcHeight, std::max(2, static_cast<int>(std::lround(geometry.height * config.tileScale))));
+    std::vector<cv::Rect> rects;
+    for (int y : positions(srcHeight, tileHeight)) {
+        for (int x : positions(srcWidth, tileWidth)) {
+            rects.emplace_back(x, y, tileWidth, tileHeight);
+        }
+    }
+    return rects;
+}
 
-    std::vector<FaceInfo> inputsTmp = inputs;
+int NativeFaceDetector::detectTiled(const cv::Mat& img, std::vector<FaceInfo>* faces,
+                                    const TileConfig& config, DetectProfile* profile,
+                                    const InputConfig& input) {
+    faces->clear();
+
+    if (!initialized_) {
+        LOGE("Model not initialized");
+        return 10000;
+    }
 
-    // 按置信度排序
-    std::sort(inputsTmp.begin(), inputsTmp.end(),
-        [](const FaceInfo& a, const FaceInfo& b) {
-            return a.score > b.score;
-        });
+    if (img.empty()) {
+        LOGE("Input image is empty");
+        return 10001;
+    }
 
-    std::vector<int> indexes(inputsTmp.size());
-    for (size_t i = 0; i < indexes.size(); i++) {
-        indexes[i] = i;
+    if (!(config.tileScale > 0) || !(config.overlap >= 0.0f && config.overlap <= 0.9f) ||
+        config.batchSize < 1 || config.maxThreads < 0) {
+        LOGE("Invalid tile config");
+        return 10003;
+    }
+    InputGeometry geometry;
+    if (!computeGeometry(input, img.cols, img.rows, &geometry)) {
+        return 10003;
     }
 
-    while (indexes.size() > 0) {
-        int indexGood = indexes[0];
-        std::vector<int> indexesTmp = indexes;
-        indexes.clear();
+    StageClock clock;
+    const std::vector<cv::Rect> rects = tileRects(img.cols, img.rows, config, input);
+    const int tileCount = static_cast<int>(rects.size());
+    const int batches = (tileCount + config.batchSize - 1) / config.batchSize;
+    // 只有一个覆盖整图的 tile 时它就是整图检测
+    const bool coarse = config.coarsePass &&
+                        !(tileCount == 1 && rects[0] == cv::Rect(0, 0, img.cols, img.rows));
+    // 任务 0 为整图检测（如果有），它通常最慢，最先开始
+    const int jobs = batches + (coarse ? 1 : 0);
+    const int threads = std::min(jobs, config.maxThreads > 0 ? config.maxThreads : sessionCount_);
 
-        std::vector<int> indexesNms;
-        indexesNms.push_back(indexGood);
+    struct TileFace {
+        FaceInfo face;
+        bool atEdge;  // 贴着 tile 在图像内部的边界，可能被截断
+    };
+    std::vector<TileFace> found;
+    DetectProfile stage;
+    std::mutex mergeMutex;
+    std::atomic<int> nextJob(0);
+    int error = 0;
 
-        for (size_t i = 1; i < indexesTmp.size(); ++i) {
-            int indexTmp = indexesTmp[i];
+    auto worker = [&] {
+        std::vector<TileFace> local;
+        DetectProfile localStage;
+        int localError = 0;
+        for (int job = nextJob++; job < jobs && localError == 0; job = nextJob++) {
+            if (coarse && job == 0) {
+                std::vector<FaceInfo> coarseFaces;
+                DetectProfile coarseProfile;
+                localError = detect(img, &coarseFaces, &coarseProfile, input);
+                for (const FaceInfo& face : coarseFaces) {
+                    local.push_back({face, false});
+                }
+                localStage.resizeMs += coarseProfile.resizeMs;
+                localStage.convertMs += coarseProfile.convertMs;
+                localStage.inferenceMs += coarseProfile.inferenceMs;
+                localStage.copyMs += coarseProfile.copyMs;
+                localStage.decodeMs += coarseProfile.decodeMs;
+                localStage.nmsMs += coarseProfile.nmsMs;
+                continue;
+            }
+            const int first = (job - (coarse ? 1 : 0)) * config.batchSize;
+            const cv::Rect* batch = rects.data() + first;
+            auto prepare = [&img, this](SessionSlot& slot, const cv::Rect& rect,
+                                        const InputGeometry& geometry, cv::Mat* resized) {
+                return matRegionSource(slot, img, rect, geometry, resized);
+            };
+            auto emit = [&](const cv::Rect& tile, const InputGeometry& tileGeometry,
+                            const FaceInfo& face) {
+                // 1 个模型输入像素以内视为贴边；tile 在图像边界上的边不算
+                const float marginX = tileGeometry.letterbox
+                    ? 1.0f / tileGeometry.scale
+                    : static_cast<float>(tile.width) / tileGeometry.width;
+                const float marginY = tileGeometry.letterbox
+                    ? 1.0f / tileGeometry.scale
+                    : static_cast<float>(tile.height) / tileGeometry.height;
+                bool atEdge = (tile.x > 0 && face.x <= tile.x + marginX) ||
+                              (tile.y > 0 && face.y <= tile.y + marginY) ||
+                              (tile.x + tile.width < img.cols &&
+                               face.x + face.width >= tile.x + tile.width - marginX) ||
+                              (tile.y + tile.height < img.rows &&
+                               face.y + face.height >= tile.y + tile.height - marginY);
+                local.push_back({face, atEdge});
+            };
+            SlotLease lease(this);
+            localError = inferRegions(*lease, batch, std::min(config.batchSize, tileCount - first),
+                                      input, prepare, emit, &localStage);
+        }
 
-            // 计算 IoU
-            float iou = 0.0f;
-            float x1 = std::max(inputsTmp[indexGood].x, inputsTmp[indexTmp].x);
-            float y1 = std::max(inputsTmp[indexGood].y, inputsTmp[indexTmp].y);
-            float x2 = std::min(inputsTmp[indexGood].x + inputsTmp[indexGood].width,
-                              inputsTmp[indexTmp].x + inputsTmp[indexTmp].width);
-            float y2 = std::min(inputsTmp[indexGood].y + inputsTmp[indexGood].height,
-                              inputsTmp[indexTmp].y + inputsTmp[indexTmp].height);
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        found.insert(found.end(), local.begin(), local.end());
+        stage.resizeMs += localStage.resizeMs;
+        stage.convertMs += localStage.convertMs;
+        stage.inferenceMs += localStage.inferenceMs;
+        stage.copyMs += localStage.copyMs;
+        stage.decodeMs += localStage.decodeMs;
+        stage.nmsMs += localStage.nmsMs;
+        if (localError != 0 && error == 0) {
+            error = localError;
+        }
+    };
 
-            float w = std::max(0.0f, x2 - x1);
-            float h = std::max(0.0f, y2 - y1);
-            float interArea = w * h;
-            float area1 = inputsTmp[indexGood].width * inputsTmp[indexGood].height;
-            float area2 = inputsTmp[indexTmp].width * inputsTmp[indexTmp].height;
-            iou = interArea / (area1 + area2 - interArea);
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    if (error != 0) {
+        LOGE("Tiled detection failed, error code: %d", error);
+        return error;
+    }
+    clock.lap();
 
-            if (iou <= threshold) {
-                indexes.push_back(indexTmp);
-            } else {
-                indexesNms.push_back(indexTmp);
+    // 被 tile 边界截断的框大部分落在同一张脸的完整检测框（相邻 tile 或整图检测）内，
+    // 与完整框的 IoU 可能低于 NMS 阈值，先单独去掉
+    std::vector<FaceInfo> candidates;
+    candidates.reserve(found.size());
+    for (size_t i = 0; i < found.size(); ++i) {
+        const FaceInfo& a = found[i].face;
+        bool covered = false;
+        for (size_t j = 0; j < found.size() && found[i].atEdge && !covered; ++j) {
+            if (j == i || found[j].atEdge) {
+                continue;
             }
+            const FaceInfo& b = found[j].face;
+            float w = std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x);
+            float h = std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y);
+            covered = w > 0 && h > 0 && w * h >= 0.5f * a.width * a.height;
+        }
+        if (!covered) {
+            candidates.push_back(a);
         }
+    }
 
-        result->push_back(inputsTmp[indexGood]);
+    // 相邻 tile 重叠部分以及整图检测中的同一张脸，跨 tile 再做一次 NMS
+    NmsEngine nms;
+    nms.run(candidates, nmsConfig_, faces);
+    stage.nmsMs += clock.lap();
+    stage.totalMs = clock.total();
+    if (profile) {
+        *profile = stage;
     }
+    LOGD("Tiled detection: %d tiles in %d batches on %d threads, %zu faces", tileCount, batches,
+         threads, faces->size());
+    return 0;
 }
 
 } // namespace facebook::react
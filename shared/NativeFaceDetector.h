@@ -3,60 +3,367 @@
 #include <opencv2/opencv.hpp>
 #include <MNN/Interpreter.hpp>
 #include <MNN/ImageProcess.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <vector>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <utility>
+#include "AnchorDecoder.h"
+#include "FaceInfo.h"
+#include "FaceNms.h"
+#include "ModelSource.h"
+#include "OpProfiler.h"
 
 namespace facebook::react {
 
-// 人脸信息结构
-struct FaceInfo {
-    float x;        // 人脸框左上角 x
-    float y;        // 人脸框左上角 y
-    float width;    // 人脸框宽度
-    float height;   // 人脸框高度
-    float score;    // 置信度
+// 预处理方式
+enum class PreprocessMode {
+    ResizeThenConvert,  // 先 cv::resize 到模型尺寸，再由 ImageProcess 做颜色转换和归一化
+    Fused,              // ImageProcess 直接从原图采样，缩放/颜色转换/归一化一次完成
+};
+
+// 单次 detect() 各阶段耗时（毫秒），供基准测试和性能分析使用
+struct DetectProfile {
+    double resizeMs = 0;     // cv::resize（Fused 模式下为 0）
+    double convertMs = 0;    // pretreat_->convert（颜色转换 + 归一化）
+    double inferenceMs = 0;  // runSession
+    double copyMs = 0;       // 输出张量拷贝到 host
+    double decodeMs = 0;     // anchor 解码
+    double nmsMs = 0;        // NMS 去重
+    double totalMs = 0;      // 整个 detect() 调用
+};
+
+// 检测器运行参数，init() 时生效
+struct DetectorOptions {
+    int numThreads = 2;  // 每个 session 的 MNN 线程数
+    MNN::BackendConfig::PrecisionMode precision = MNN::BackendConfig::Precision_Normal;
+    MNN::BackendConfig::MemoryMode memory = MNN::BackendConfig::Memory_Normal;
+    MNN::BackendConfig::PowerMode power = MNN::BackendConfig::Power_Normal;
+    int inputWidth = 320;          // 模型输入尺寸，anchors 随之生成
+    int inputHeight = 240;
+    float scoreThreshold = 0.95f;  // 提高阈值减少误检
+    float iouThreshold = 0.3f;     // 写入 NmsConfig::iouThreshold
+    int maxFaces = 0;              // 写入 NmsConfig::maxDetections，0 表示不限制
+    // session 创建完成后调用 Interpreter::releaseModel() 释放权重的堆拷贝。
+    // 释放后不能再创建新 session：需要的批大小 / 输入尺寸列在下面两项中，
+    // 或设为 false 保留缓冲按需创建
+    bool releaseModelAfterInit = true;
+    // init() 在释放模型缓冲之前一并创建的 session，之后不依赖模型缓冲：
+    // batchSizes 为 detectBatch() / 多区域 / 多 tile 的批大小（默认尺寸和 inputSizes 中
+    // 每种尺寸各一个），inputSizes 为按次传给 detect() 的其他输入尺寸。
+    // 每个 session 都有自己的一份权重和中间张量，只列出确实会用到的
+    std::vector<int> batchSizes;
+    std::vector<std::pair<int, int>> inputSizes;
+};
+
+// 单次检测的模型输入配置
+struct InputConfig {
+    int width = 0;           // 模型输入尺寸，0 表示使用 DetectorOptions 中的尺寸
+    int height = 0;
+    bool letterbox = false;  // 保持宽高比缩放到输入尺寸内，其余区域补黑边
+};
 
-    FaceInfo() : x(0), y(0), width(0), height(0), score(0) {}
+// 区域检测参数（detectInRegions）
+struct RegionConfig {
+    float expand = 2.0f;    // 区域边长相对于给定人脸框的倍数，以框中心为中心
+    int maxRegions = 8;     // 最多检测的区域数（即批大小上限），超出时保留分数高的
+    float mergeIoU = 0.5f;  // 扩展后 IoU 超过该值的区域合并为外接矩形
 };
 
+// 分块检测参数（detectTiled）
+struct TileConfig {
+    float tileScale = 1.0f;  // tile 边长相对模型输入的倍数，1 表示 tile 像素不缩放直接送入模型
+    float overlap = 0.25f;   // 相邻 tile 的重叠比例 [0, 0.9]，不超过重叠宽度的人脸总能完整落在某个 tile 内
+    int batchSize = 4;       // 每次推理的 tile 数
+    int maxThreads = 0;      // 并行推理的线程数，0 表示 session 数（setSessionCount）
+    bool coarsePass = true;  // 另做一次整图检测，找出大于 tile 的人脸
+};
+
+// 原始像素缓冲区（相机帧等），不拥有数据
+// NV21 / NV12 要求 UV 平面紧跟在 Y 平面之后，且两个平面行跨度相同
+struct PixelBuffer {
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;  // 每行字节数（YUV 为 Y 平面），0 表示紧密排列
+    MNN::CV::ImageFormat format = MNN::CV::RGBA;
+};
+
+// 人脸检测器
+// 一个 Interpreter（权重只加载一次）+ N 个 session 组成的池，每个 session 有独立的
+// 输入/输出张量、ImageProcess 和临时缓冲。detect() / detectBatch() 从池中取一个空闲
+// session，可在多个线程中并发调用；池中无空闲 session 时等待。
+// init() 和 set*() 不能与检测并发调用。
 class NativeFaceDetector {
 public:
     NativeFaceDetector();
     ~NativeFaceDetector();
 
-    // 初始化模型
-    int init(const std::string& modelPath);
+    // 设置 session 数量（即最大并发检测数，默认 1），在 init() 前调用
+    void setSessionCount(int count);
+
+    // 初始化模型：只读 mmap 模型文件后用 createFromBuffer 创建解释器，init 返回前解除映射。
+    // 文件无法打开或映射时返回 10004，options 不合法时返回 10003
+    int init(const std::string& modelPath, const DetectorOptions& options = DetectorOptions());
+
+    // 从调用方持有的内存初始化（MNN 会拷贝一份），buffer 只需在调用期间有效
+    int init(const void* buffer, size_t size, const DetectorOptions& options = DetectorOptions());
+
+    // 从模型来源（文件映射 / APK asset / 内存）初始化，来源无效时返回 10004
+    int init(const ModelSource& model, const DetectorOptions& options = DetectorOptions());
 
-    // 检测人脸
-    int detect(const cv::Mat& img, std::vector<FaceInfo>* faces);
+    const DetectorOptions& options() const { return options_; }
+
+    // detectBatch() 能否以该批大小一次推理：模型缓冲仍保留，或 init 时已创建（batchSizes）
+    bool supportsBatch(int batch) const;
+
+    // 设置预处理方式和采样滤波器（默认 Fused + BILINEAR），可在 init() 前后调用
+    void setPreprocess(PreprocessMode mode, MNN::CV::Filter filter);
+
+    // 设置 NMS 模式、IoU 阈值和最大输出数（默认 Greedy, IoU 0.3）。
+    // init() 会用 DetectorOptions 中的 iouThreshold / maxFaces 覆盖对应字段
+    void setNms(const NmsConfig& config);
+
+    // 检测人脸；profile 非空时写入各阶段耗时。
+    // input 指定本次的模型输入尺寸和是否 letterbox，坐标总是映射回原图。
+    // 每种输入尺寸的 session 和 anchors 在首次使用时创建并缓存；非默认尺寸需要
+    // 模型缓冲仍在（releaseModelAfterInit = false）或已在 init 时创建（inputSizes），
+    // 否则返回 10000。
+    // 尺寸不合法时返回 10003
+    int detect(const cv::Mat& img, std::vector<FaceInfo>* faces,
+               DetectProfile* profile = nullptr, const InputConfig& input = InputConfig());
+
+    // 直接从像素缓冲区检测：ImageProcess 一次完成缩放、颜色转换和归一化，
+    // 结果写入输入张量，不经过 cv::Mat。支持 RGBA / BGRA / RGB / BGR / GRAY / NV21 / NV12
+    int detect(const PixelBuffer& frame, std::vector<FaceInfo>* faces,
+               DetectProfile* profile = nullptr, const InputConfig& input = InputConfig());
+
+    // 批量检测：一次 runSession 处理多张图像，faces 按输入顺序输出每张图的结果。
+    // 每种批大小首次使用时创建并缓存一个 session，之后不再 resizeSession；
+    // 模型缓冲已释放且 init 时未创建该批大小（batchSizes）时逐张用默认 session 推理
+    int detectBatch(const std::vector<cv::Mat>& imgs,
+                    std::vector<std::vector<FaceInfo>>* faces);
+
+    // 只在已知人脸附近重新检测：regions（通常是上一帧的结果）中每个框按 config.expand
+    // 扩大为与模型输入宽高比相同的区域，所有区域以模型分辨率一次批量推理，
+    // 结果映射回原图坐标后做跨区域 NMS。比整帧缩放到模型尺寸的有效分辨率更高。
+    // input 与 detect() 相同：区域按该输入尺寸的宽高比扩展，letterbox 对每个区域生效。
+    // 多个区域时使用该输入尺寸的批量 session，模型缓冲已释放且该批大小未缓存时
+    // 退化为逐个区域用单图 session 推理；非默认尺寸的单图 session 同样需要模型缓冲，
+    // 否则返回 10000。regions 为空时直接返回 0，faces 为空
+    int detectInRegions(const cv::Mat& img, const std::vector<FaceInfo>& regions,
+                        std::vector<FaceInfo>* faces,
+                        const RegionConfig& config = RegionConfig(),
+                        DetectProfile* profile = nullptr, const InputConfig& input = InputConfig());
+    int detectInRegions(const PixelBuffer& frame, const std::vector<FaceInfo>& regions,
+                        std::vector<FaceInfo>* faces,
+                        const RegionConfig& config = RegionConfig(),
+                        DetectProfile* profile = nullptr, const InputConfig& input = InputConfig());
+
+    // 分块检测大图中的小脸：把原图切成互相重叠、与模型输入同宽高比的 tile，
+    // 每 batchSize 个 tile 一次批量推理，多个批次在 session 池上并行；
+    // 结果映射回原图后去掉被 tile 边界截断的重复框，再做跨 tile NMS。
+    // input 与 detect() 相同：tile 大小按该输入尺寸计算，letterbox 对每个 tile 和整图检测生效。
+    // profile 中各阶段为所有线程的耗时之和，totalMs 为实际耗时。
+    // 配置不合法时返回 10003
+    int detectTiled(const cv::Mat& img, std::vector<FaceInfo>* faces,
+                    const TileConfig& config = TileConfig(), DetectProfile* profile = nullptr,
+                    const InputConfig& input = InputConfig());
+
+    // 原图为 srcWidth x srcHeight 时的 tile 划分（按行优先），供测试和预估耗时使用；
+    // input 不合法时返回空
+    std::vector<cv::Rect> tileRects(int srcWidth, int srcHeight, const TileConfig& config,
+                                    const InputConfig& input = InputConfig()) const;
+
+    // 逐算子计时（见 OpProfiler）：开启后所有推理改用 runSessionWithCallBackInfo，
+    // 按算子累计耗时和计算量，有额外开销，只用于分析。开启时清空之前的统计
+    void setOpProfiling(bool enabled);
+    bool opProfiling() const { return opProfiling_; }
+    OpReport opReport() const { return opProfiler_.report(); }
 
 private:
+    // 某个批大小对应的 session
+    struct BatchSession {
+        MNN::Session* session = nullptr;
+        MNN::Tensor* input = nullptr;
+        std::shared_ptr<MNN::Tensor> hostInput;  // NHWC host 张量，逐图写入后整体拷贝
+    };
+
+    // 某个输入尺寸对应的单图 session
+    struct SizedSession {
+        MNN::Session* session = nullptr;
+        MNN::Tensor* input = nullptr;
+    };
+
+    // 一次检测的输入几何：模型输入尺寸，以及原图到输入的缩放和 letterbox 边距
+    struct InputGeometry {
+        int width = 0;         // 模型输入尺寸
+        int height = 0;
+        bool letterbox = false;
+        float scale = 1.0f;    // letterbox 时原图到输入的等比缩放
+        float padX = 0.0f;     // letterbox 边距（输入像素，取整）
+        float padY = 0.0f;
+    };
+
+    // 池中的一个 session 及其独占的预处理器和临时缓冲
+    struct SessionSlot {
+        MNN::Session* session = nullptr;  // 默认输入尺寸
+        MNN::Tensor* input = nullptr;
+        std::shared_ptr<MNN::CV::ImageProcess> pretreat;
+        // 按 (源格式, 是否 letterbox) 缓存，letterbox 用 ZERO 边缘填充
+        std::map<int, std::shared_ptr<MNN::CV::ImageProcess>> framePretreats;
+        std::map<std::pair<int, int>, SizedSession> sizedSessions;  // 其他输入尺寸
+        std::map<std::tuple<int, int, int>, BatchSession> batchSessions;  // (批大小, 宽, 高)
+        NmsEngine nms;
+        // 每帧复用的临时缓冲，避免重复分配
+        std::vector<int> candidates;
+        std::vector<FaceInfo> facesTmp;
+        std::vector<FaceInfo> regionFaces;  // detectInRegions：单个区域 / 所有区域的结果
+        std::vector<FaceInfo> allRegionFaces;
+        std::vector<InputGeometry> regionGeometries;  // inferRegions：每个区域的输入几何
+    };
+
+    // 一个检测区域的预处理源：pretreat 已设置好把模型输入映射到该区域的矩阵
+    struct RegionSource {
+        MNN::CV::ImageProcess* pretreat = nullptr;
+        const uint8_t* data = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+    };
+
+    // 借出一个空闲 session，析构时归还
+    class SlotLease {
+    public:
+        explicit SlotLease(NativeFaceDetector* owner) : owner_(owner), slot_(owner->acquireSlot()) {}
+        ~SlotLease() { owner_->releaseSlot(slot_); }
+        SlotLease(const SlotLease&) = delete;
+        SlotLease& operator=(const SlotLease&) = delete;
+        SessionSlot& operator*() const { return *slot_; }
+
+    private:
+        NativeFaceDetector* owner_;
+        SessionSlot* slot_;
+    };
+
     bool initialized_;
+    bool modelReleased_;  // 已调用 releaseModel()，不能再创建 session
+    // 模型已释放、无法创建 session 的提示只输出一次（区域 / tile / 扫描会逐帧退化到单图推理）
+    std::atomic<bool> releasedWarned_{false};
     std::shared_ptr<MNN::Interpreter> interpreter_;
-    MNN::Session* session_;
-    MNN::Tensor* inputTensor_;
-    std::shared_ptr<MNN::CV::ImageProcess> pretreat_;
-
-    // 模型参数（来自 UltraFace）
-    const int inputSizeWidth_ = 320;
-    const int inputSizeHeight_ = 240;
-    const float meanVals_[3] = {127.0f, 127.0f, 127.0f};
-    const float normVals_[3] = {1.0f / 128.0f, 1.0f / 128.0f, 1.0f / 128.0f};
-    const float scoreThreshold_ = 0.95f;  // 提高阈值减少误检
-    const float iouThreshold_ = 0.3f;
-
-    // 生成 anchors
-    int generateAnchors(const int& width, const int& height,
-                       const std::vector<std::vector<float>>& minBoxes,
-                       const std::vector<float>& strides,
-                       std::vector<std::vector<float>>* anchors);
-
-    // NMS 去重
-    void nms(const std::vector<FaceInfo>& inputs, std::vector<FaceInfo>* result,
-             const float& threshold);
-
-    std::vector<std::vector<float>> anchors_;
+    MNN::ScheduleConfig scheduleConfig_;
+    MNN::BackendConfig backendConfig_;
+    std::mutex interpreterMutex_;  // createSession / resizeSession 不是线程安全的
+    PreprocessMode preprocessMode_;
+    MNN::CV::Filter filter_;
+
+    int sessionCount_;
+    std::vector<std::unique_ptr<SessionSlot>> slots_;
+    std::vector<SessionSlot*> freeSlots_;
+    std::mutex poolMutex_;
+    std::condition_variable poolCv_;
+
+    std::atomic<bool> opProfiling_{false};
+    OpProfiler opProfiler_;
+
+    // 模型参数（来自 UltraFace，见 UltraFaceModel.h），输入尺寸和阈值由 DetectorOptions 决定
+    DetectorOptions options_;
+    int inputSizeWidth_;
+    int inputSizeHeight_;
+    float scoreThreshold_;
+
+    // 按当前滤波器创建源格式为 sourceFormat 的 ImageProcess
+    std::shared_ptr<MNN::CV::ImageProcess> createPretreat(MNN::CV::ImageFormat sourceFormat,
+                                                          bool letterbox = false);
+
+    // slot 上源格式为 format 的 ImageProcess（BGR 且不 letterbox 时即 slot.pretreat）
+    MNN::CV::ImageProcess* getPretreat(SessionSlot& slot, MNN::CV::ImageFormat format,
+                                       bool letterbox);
+
+    // 创建一个输入为 {batch, 3, height, width} 的 session
+    MNN::Session* createSession(int batch, int width, int height, MNN::Tensor** input);
+
+    // 校验 input 并计算原图为 srcWidth x srcHeight 时的输入几何，不合法时返回 false
+    bool computeGeometry(const InputConfig& input, int srcWidth, int srcHeight,
+                         InputGeometry* geometry) const;
+
+    // 获取（必要时创建）slot 上该输入尺寸的 session，默认尺寸即 slot.session；
+    // 模型已释放且未缓存时返回 false（见 reportModelReleased）
+    bool getSizedSession(SessionSlot& slot, int width, int height, SizedSession* sized);
+
+    // 该输入尺寸的 anchors，首次使用时生成并缓存（所有 slot 共享）
+    const AnchorTable& getAnchors(int width, int height);
+
+    // 原图坐标 -> 输入坐标的采样矩阵（MNN 的矩阵把输入坐标映射回原图）
+    static MNN::CV::Matrix sourceMatrix(const InputGeometry& geometry, int srcWidth, int srcHeight);
+
+    // 模型已释放、无法创建 what 描述的 session：每个检测器第一次 LOGW，之后 LOGD
+    void reportModelReleased(const char* what, int batch, int width, int height);
+
+    // 释放所有 session
+    void releaseSessions();
+
+    SessionSlot* acquireSlot();
+    void releaseSlot(SessionSlot* slot);
+
+    // 获取（必要时创建）slot 上批大小为 batch、输入为 width x height 的 session；
+    // 模型已释放且未缓存时返回 nullptr（调用方退化为逐个推理，只在第一次时警告）
+    BatchSession* getBatchSession(SessionSlot& slot, int batch, int width, int height);
+
+    // 设置 pretreat 的采样矩阵并返回送入 ImageProcess 的源图：
+    // Fused 模式为原图，否则为 cv::resize（letterbox 时再补边）到模型尺寸后的 resized
+    const cv::Mat& prepareSource(MNN::CV::ImageProcess* pretreat, const InputGeometry& geometry,
+                                 const cv::Mat& img, cv::Mat* resized);
+
+    // 运行推理，开启逐算子计时时经过 opProfiler_
+    void runSession(MNN::Session* session);
+
+    // 查找 scores / boxes 输出张量
+    bool getOutputs(MNN::Session* session, MNN::Tensor** scores, MNN::Tensor** boxes);
+
+    // 原图中的检测区域（见 detectInRegions），宽高比与 geometry 的模型输入相同，
+    // 按分数从高到低，最多 config.maxRegions 个。letterbox 时合并后的区域也扩展回该宽高比，
+    // 黑边只出现在区域被原图边界截断的一侧（即原图之外）
+    std::vector<cv::Rect> regionRects(const std::vector<FaceInfo>& regions, int srcWidth,
+                                      int srcHeight, const RegionConfig& config,
+                                      const InputGeometry& geometry) const;
+
+    // 从 cv::Mat 的子区域采样的预处理源（Fused 模式下不拷贝子图）
+    RegionSource matRegionSource(SessionSlot& slot, const cv::Mat& img, const cv::Rect& rect,
+                                 const InputGeometry& geometry, cv::Mat* resized);
+
+    // rects 中的 count 个区域按 input 一次推理：prepare(slot, rect, geometry, &resized)
+    // 返回区域的预处理源，每个检测框平移回原图坐标后调用 emit(所在区域, 区域的输入几何, face)，
+    // 各阶段耗时累加到 stage。批量 session 不可用时逐个区域推理
+    template <typename PrepareFn, typename EmitFn>
+    int inferRegions(SessionSlot& slot, const cv::Rect* rects, int count, const InputConfig& input,
+                     PrepareFn& prepare, EmitFn& emit, DetectProfile* stage);
+
+    // 所有区域一次推理并做跨区域 NMS（detectInRegions）
+    template <typename PrepareFn>
+    int runRegions(const std::vector<cv::Rect>& rects, const InputConfig& input,
+                   PrepareFn&& prepare, std::vector<FaceInfo>* faces, DetectProfile* profile);
+
+    // 输入张量已填好后：推理、拷贝输出、解码和 NMS，并记录对应阶段耗时
+    int runDetection(SessionSlot& slot, MNN::Session* session, const InputGeometry& geometry,
+                     int width, int height, std::vector<FaceInfo>* faces, DetectProfile* stage);
+
+    // 解码单张图像的输出并做 NMS，坐标映射回 width x height 的原图；
+    // 320x240 输入走编译期特化的解码器，其他尺寸用 getAnchors() 的通用路径；
+    // decodeMs / nmsMs 非空时写入耗时
+    void decodeOutputs(SessionSlot& slot, const InputGeometry& geometry, const float* scoreData,
+                       const float* bboxData, int width, int height,
+                       std::vector<FaceInfo>* faces, double* decodeMs, double* nmsMs);
+
+    AnchorTable anchors_;  // 默认输入尺寸（320x240 时为空，使用编译期 anchor 表）
+    std::map<std::pair<int, int>, AnchorTable> sizedAnchors_;  // 其他输入尺寸
+    std::mutex anchorsMutex_;
+    NmsConfig nmsConfig_;
 };
 
 } // namespace facebook::react
@@ -1,46 +1,471 @@
 #include "NativeSampleModule.h"
-#include <fstream>
+#include "DetectorTuner.h"
+#include "ImageLoader.h"
+#include "JsonUtil.h"
+#include "Log.h"
+#include "PerfStats.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <exception>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-// 平台特定的头文件和日志宏
+#define TAG "NativeSampleModule"
+
+// 平台特定的头文件和模型加载
 #ifdef __ANDROID__
+  #include "AssetModel.h"
   #include "ModelJni.h"
-  #include <android/log.h>
-  #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
-  #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+  #define PLATFORM_NAME "Android"
+  #define MODEL_PATH_HINT "Make sure ModelExtractor.registerModel() was called."
+  // 模型直接从 APK 读取（noCompress，AAsset 映射 APK 中的数据），不解压到磁盘
+  static const char* platformModelName() { return getModelAssetName(); }
+  static std::unique_ptr<facebook::react::ModelSource> openPlatformModel(const char* name) {
+    auto model = std::make_unique<AssetModel>();
+    if (!model->open(getAssetManager(), name)) {
+      return nullptr;
+    }
+    if (!model->mapped()) {
+      LOGW("Model asset is compressed, decompressed into heap memory");
+    }
+    return model;
+  }
+  static std::string platformCacheDir() {
+    const char* dir = getCacheDir();
+    return dir ? dir : "";
+  }
 #else
   // iOS - 使用纯 C 前向声明，不包含 Objective-C++ 头文件
-  #include <cstdio>
+  #include "MappedModel.h"
+  #include <cstdlib>
   extern "C" {
     const char* getIOSModelPath(void);
   }
-  #define LOGI(fmt, ...) printf("[INFO] " fmt "\n", ##__VA_ARGS__)
-  #define LOGE(fmt, ...) fprintf(stderr, "[ERROR] " fmt "\n", ##__VA_ARGS__)
+  #define PLATFORM_NAME "iOS"
+  #define MODEL_PATH_HINT "Make sure iOSModelLoader.setModelPath() was called in AppDelegate."
+  static const char* platformModelName() { return getIOSModelPath(); }
+  // 模型在 app bundle 中，只读 mmap
+  static std::unique_ptr<facebook::react::ModelSource> openPlatformModel(const char* path) {
+    auto model = std::make_unique<facebook::react::MappedModel>();
+    if (!model->map(path)) {
+      return nullptr;
+    }
+    return model;
+  }
+  // 模型在只读的 app bundle 中，调优结果放在沙盒的 Library/Caches
+  static std::string platformCacheDir() {
+    const char* home = getenv("HOME");
+    return std::string(home ? home : "") + "/Library/Caches";
+  }
 #endif
 
-#define TAG "NativeSampleModule"
-
 namespace facebook::react {
 
+namespace {
+
+// 构建错误 JSON：{"error":"..."}
+std::string errorJson(const std::string& message) {
+  return "{\"error\":\"" + jsonEscape(message) + "\"}";
+}
+
+// 构建人脸数组 JSON：[{x, y, width, height, score}, ...]
+std::string facesArrayJson(const std::vector<FaceInfo>& faces) {
+  std::string json = "[";
+  for (size_t i = 0; i < faces.size(); i++) {
+    const FaceInfo& face = faces[i];
+    json += "{";
+    json += "\"x\":" + std::to_string(static_cast<int>(face.x)) + ",";
+    json += "\"y\":" + std::to_string(static_cast<int>(face.y)) + ",";
+    json += "\"width\":" + std::to_string(static_cast<int>(face.width)) + ",";
+    json += "\"height\":" + std::to_string(static_cast<int>(face.height)) + ",";
+    json += "\"score\":" + std::to_string(face.score);
+    json += "}";
+    if (i < faces.size() - 1) {
+      json += ",";
+    }
+  }
+  json += "]";
+  return json;
+}
+
+// 构建结果 JSON
+std::string facesToJson(const std::vector<FaceInfo>& faces) {
+  return "{\"faces\":" + facesArrayJson(faces) + "}";
+}
+
+// 构建扫描进度 JSON：累计计数和本批结果，结果用 index 对应 paths 中的位置
+std::string scanProgressToJson(int jobId, const ScanProgress& progress) {
+  static const char* kStates[] = {"running", "paused", "done", "cancelled"};
+  std::string json = "{\"jobId\":" + std::to_string(jobId) +
+                     ",\"state\":\"" + kStates[static_cast<int>(progress.state)] + "\"" +
+                     ",\"processed\":" + std::to_string(progress.processed) +
+                     ",\"total\":" + std::to_string(progress.total) +
+                     ",\"cached\":" + std::to_string(progress.cached) +
+                     ",\"failed\":" + std::to_string(progress.failed) + ",\"results\":[";
+  for (size_t i = 0; i < progress.results.size(); i++) {
+    const ScanResult& result = progress.results[i];
+    json += "{\"index\":" + std::to_string(result.index);
+    if (result.error != 0) {
+      json += std::string(",\"error\":\"") +
+              (result.error == 10001 ? "Failed to read image" : "Detection failed") +
+              "\",\"code\":" + std::to_string(result.error) + "}";
+    } else {
+      json += ",\"faces\":" + facesArrayJson(result.faces) + "}";
+    }
+    if (i < progress.results.size() - 1) {
+      json += ",";
+    }
+  }
+  json += "]}";
+  return json;
+}
+
+// 构建视频模式的结果 JSON，比 facesToJson 多出轨迹 id 和本帧是否检测
+std::string trackedToJson(const std::vector<TrackedFace>& faces, bool detected) {
+  std::string json = "{\"faces\":[";
+  for (size_t i = 0; i < faces.size(); i++) {
+    const FaceInfo& face = faces[i].face;
+    json += "{";
+    json += "\"x\":" + std::to_string(static_cast<int>(face.x)) + ",";
+    json += "\"y\":" + std::to_string(static_cast<int>(face.y)) + ",";
+    json += "\"width\":" + std::to_string(static_cast<int>(face.width)) + ",";
+    json += "\"height\":" + std::to_string(static_cast<int>(face.height)) + ",";
+    json += "\"score\":" + std::to_string(face.score) + ",";
+    json += "\"id\":" + std::to_string(faces[i].id);
+    json += "}";
+    if (i < faces.size() - 1) {
+      json += ",";
+    }
+  }
+  json += std::string("],\"detected\":") + (detected ? "true" : "false") + "}";
+  return json;
+}
+
+// 持有 Float32Array 底层数据的 jsi::MutableBuffer
+class FloatBuffer : public jsi::MutableBuffer {
+public:
+  explicit FloatBuffer(size_t count) : data_(count) {}
+  size_t size() const override { return data_.size() * sizeof(float); }
+  uint8_t* data() override { return reinterpret_cast<uint8_t*>(data_.data()); }
+  float* floats() { return data_.data(); }
+
+private:
+  std::vector<float> data_;
+};
+
+// 直接从 FaceInfo 构建 JS 结果，坐标保留浮点精度：
+// packed 为 false 时返回 [{x, y, width, height, score}, ...]，
+// 为 true 时返回 Float32Array，每 5 个数为一个 [x, y, w, h, score]
+jsi::Object facesToJsi(jsi::Runtime& rt, const std::vector<FaceInfo>& faces, bool packed) {
+  if (packed) {
+    auto buffer = std::make_shared<FloatBuffer>(faces.size() * 5);
+    float* out = buffer->floats();
+    for (const FaceInfo& face : faces) {
+      *out++ = face.x;
+      *out++ = face.y;
+      *out++ = face.width;
+      *out++ = face.height;
+      *out++ = face.score;
+    }
+    jsi::ArrayBuffer arrayBuffer(rt, buffer);
+    return rt.global()
+        .getPropertyAsFunction(rt, "Float32Array")
+        .callAsConstructor(rt, arrayBuffer)
+        .asObject(rt);
+  }
+
+  jsi::Array array(rt, faces.size());
+  for (size_t i = 0; i < faces.size(); i++) {
+    const FaceInfo& face = faces[i];
+    jsi::Object obj(rt);
+    obj.setProperty(rt, "x", static_cast<double>(face.x));
+    obj.setProperty(rt, "y", static_cast<double>(face.y));
+    obj.setProperty(rt, "width", static_cast<double>(face.width));
+    obj.setProperty(rt, "height", static_cast<double>(face.height));
+    obj.setProperty(rt, "score", static_cast<double>(face.score));
+    array.setValueAtIndex(rt, i, std::move(obj));
+  }
+  return std::move(array);
+}
+
+// 像素格式名称 -> MNN 格式和每像素字节数（YUV 为 Y 平面）
+bool parsePixelFormat(const std::string& name, MNN::CV::ImageFormat* format, int* bpp) {
+  struct Entry {
+    const char* name;
+    MNN::CV::ImageFormat format;
+    int bpp;
+  };
+  static const Entry kFormats[] = {
+    {"rgba", MNN::CV::RGBA, 4},
+    {"bgra", MNN::CV::BGRA, 4},
+    {"rgb", MNN::CV::RGB, 3},
+    {"bgr", MNN::CV::BGR, 3},
+    {"gray", MNN::CV::GRAY, 1},
+    {"nv21", MNN::CV::YUV_NV21, 1},
+    {"nv12", MNN::CV::YUV_NV12, 1},
+  };
+  for (const auto& entry : kFormats) {
+    if (name == entry.name) {
+      *format = entry.format;
+      *bpp = entry.bpp;
+      return true;
+    }
+  }
+  return false;
+}
+
+// 'normal' / 'high' / 'low' -> MNN BackendConfig 枚举值（三种模式的取值一致）
+bool parseBackendMode(const std::string& name, int* mode) {
+  if (name == "normal") {
+    *mode = 0;
+  } else if (name == "high") {
+    *mode = 1;
+  } else if (name == "low") {
+    *mode = 2;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// 模型文件名（或路径）-> 模型 id："/a/b/RFB-320.mnn" -> "RFB-320"
+std::string modelIdFromFile(const std::string& file) {
+  size_t begin = file.find_last_of('/');
+  begin = begin == std::string::npos ? 0 : begin + 1;
+  size_t end = file.size();
+  if (end - begin > 4 && file.compare(end - 4, 4, ".mnn") == 0) {
+    end -= 4;
+  }
+  return file.substr(begin, end - begin);
+}
+
+// 模型 id -> 与默认模型同目录的文件（Android 为 asset 名，iOS 为 bundle 内路径）
+std::string modelFileForId(const std::string& defaultFile, const std::string& id) {
+  size_t slash = defaultFile.find_last_of('/');
+  std::string dir = slash == std::string::npos ? "" : defaultFile.substr(0, slash + 1);
+  return dir + id + ".mnn";
+}
+
+// 进程内唯一的模型注册表：JS 重新加载后新的模块实例仍可复用已加载的模型
+ModelRegistry& sharedModelRegistry() {
+  static ModelRegistry registry(32u << 20);
+  return registry;
+}
+
+// 解析 JS 传入的 DetectorOptions，未提供的字段保持默认值；失败时返回错误信息
+std::string parseDetectorOptions(jsi::Runtime& rt, const jsi::Object& obj,
+                                 DetectorInitOptions* initOptions) {
+  DetectorOptions* options = &initOptions->detector;
+  jsi::Value model = obj.getProperty(rt, "model");
+  if (model.isString()) {
+    initOptions->model = model.asString(rt).utf8(rt);
+    // id 只能是文件名（字母、数字、'-'、'_'），不能借此读取其他目录下的文件
+    const std::string& id = initOptions->model;
+    bool valid = !id.empty() && std::all_of(id.begin(), id.end(), [](char c) {
+      return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+    });
+    if (!valid) {
+      return "Invalid model id";
+    }
+  }
+  jsi::Value autoTune = obj.getProperty(rt, "autoTune");
+  initOptions->autoTune = autoTune.isBool() && autoTune.getBool();
+  jsi::Value tuneImagePath = obj.getProperty(rt, "tuneImagePath");
+  if (tuneImagePath.isString()) {
+    initOptions->tuneImagePath = tuneImagePath.asString(rt).utf8(rt);
+  }
+  if (initOptions->autoTune && initOptions->tuneImagePath.empty()) {
+    return "autoTune requires tuneImagePath";
+  }
+
+  auto readNumber = [&](const char* name, auto* field) {
+    jsi::Value value = obj.getProperty(rt, name);
+    if (value.isNumber()) {
+      *field = static_cast<std::remove_pointer_t<decltype(field)>>(value.asNumber());
+    }
+  };
+  readNumber("numThreads", &options->numThreads);
+  readNumber("inputWidth", &options->inputWidth);
+  readNumber("inputHeight", &options->inputHeight);
+  readNumber("scoreThreshold", &options->scoreThreshold);
+  readNumber("iouThreshold", &options->iouThreshold);
+  readNumber("maxFaces", &options->maxFaces);
+  jsi::Value letterbox = obj.getProperty(rt, "letterbox");
+  initOptions->letterbox = letterbox.isBool() && letterbox.getBool();
+  jsi::Value cacheResults = obj.getProperty(rt, "cacheResults");
+  if (cacheResults.isBool()) {
+    initOptions->cacheResults = cacheResults.getBool();
+  }
+  jsi::Value cacheContentHash = obj.getProperty(rt, "cacheContentHash");
+  initOptions->cacheContentHash = cacheContentHash.isBool() && cacheContentHash.getBool();
+
+  int precision = options->precision;
+  int memory = options->memory;
+  int power = options->power;
+  const std::pair<const char*, int*> modeFields[] = {
+    {"precision", &precision}, {"memory", &memory}, {"power", &power}};
+  for (const auto& [name, mode] : modeFields) {
+    jsi::Value value = obj.getProperty(rt, name);
+    if (!value.isString()) {
+      continue;
+    }
+    std::string modeStr = value.asString(rt).utf8(rt);
+    if (!parseBackendMode(modeStr, mode)) {
+      return std::string("Invalid ") + name + ": " + modeStr;
+    }
+  }
+  options->precision = static_cast<MNN::BackendConfig::PrecisionMode>(precision);
+  options->memory = static_cast<MNN::BackendConfig::MemoryMode>(memory);
+  options->power = static_cast<MNN::BackendConfig::PowerMode>(power);
+  return "";
+}
+
+// 解析 JS 传入的 TrackerOptions，未提供的字段保持默认值
+void parseTrackerOptions(jsi::Runtime& rt, const jsi::Object& obj, TrackerOptions* options) {
+  auto readNumber = [&](const char* name, auto* field) {
+    jsi::Value value = obj.getProperty(rt, name);
+    if (value.isNumber()) {
+      *field = static_cast<std::remove_pointer_t<decltype(field)>>(value.asNumber());
+    }
+  };
+  readNumber("detectInterval", &options->detectInterval);
+  readNumber("minTrackQuality", &options->minTrackQuality);
+  readNumber("matchIoU", &options->matchIoU);
+  readNumber("smoothing", &options->smoothing);
+}
+
+void parseTileOptions(jsi::Runtime& rt, const jsi::Object& obj, TileConfig* config) {
+  auto readNumber = [&](const char* name, auto* field) {
+    jsi::Value value = obj.getProperty(rt, name);
+    if (value.isNumber()) {
+      *field = static_cast<std::remove_pointer_t<decltype(field)>>(value.asNumber());
+    }
+  };
+  readNumber("tileScale", &config->tileScale);
+  readNumber("overlap", &config->overlap);
+  readNumber("batchSize", &config->batchSize);
+  jsi::Value coarse = obj.getProperty(rt, "coarsePass");
+  if (coarse.isBool()) {
+    config->coarsePass = coarse.getBool();
+  }
+}
+
+// JS number 转为 [0, limit] 内的 int；NaN、无穷和越界的值直接转换是未定义行为
+bool toBoundedInt(double value, int limit, int* out) {
+  if (!std::isfinite(value) || value < 0 || value > limit) {
+    return false;
+  }
+  *out = static_cast<int>(value);
+  return true;
+}
+
+// 解析 JS 传入的 ScanOptions，未提供的字段保持默认值；取值不合法时返回 false
+bool parseScanOptions(jsi::Runtime& rt, const jsi::Object& obj, ScanConfig* config) {
+  bool valid = true;
+  auto readNumber = [&](const char* name, int* field) {
+    jsi::Value value = obj.getProperty(rt, name);
+    if (value.isNumber()) {
+      valid = toBoundedInt(value.asNumber(), 1 << 16, field) && valid;
+    }
+  };
+  readNumber("decodeThreads", &config->decodeThreads);
+  readNumber("inferThreads", &config->inferThreads);
+  readNumber("batchSize", &config->batchSize);
+  readNumber("queueDepth", &config->queueDepth);
+  readNumber("progressInterval", &config->progressInterval);
+  return valid && config->decodeThreads >= 0 && config->inferThreads >= 1 &&
+         config->batchSize >= 1 && config->queueDepth >= 1 && config->progressInterval >= 1;
+}
+
+// 解析 JS 传入的 PixelFrame，失败时返回错误信息
+std::string parsePixelFrame(jsi::Runtime& rt, const jsi::Object& frame, PixelBuffer* buffer) {
+  // 帧边长上限 32768，行字节数上限按 4 字节/像素；大小计算都用 size_t，不会溢出
+  constexpr int kMaxSide = 1 << 15;
+  jsi::Value widthValue = frame.getProperty(rt, "width");
+  jsi::Value heightValue = frame.getProperty(rt, "height");
+  if (!widthValue.isNumber() || !heightValue.isNumber() ||
+      !toBoundedInt(widthValue.asNumber(), kMaxSide, &buffer->width) ||
+      !toBoundedInt(heightValue.asNumber(), kMaxSide, &buffer->height) ||
+      buffer->width <= 0 || buffer->height <= 0) {
+    return "Invalid frame size";
+  }
+
+  int bpp = 0;
+  std::string formatName = frame.getProperty(rt, "format").asString(rt).utf8(rt);
+  if (!parsePixelFormat(formatName, &buffer->format, &bpp)) {
+    return "Unsupported pixel format: " + formatName;
+  }
+
+  jsi::Value strideValue = frame.getProperty(rt, "stride");
+  buffer->stride = 0;
+  if (strideValue.isNumber() &&
+      !toBoundedInt(strideValue.asNumber(), kMaxSide * 4, &buffer->stride)) {
+    return "Invalid stride";
+  }
+  const size_t packedRow = static_cast<size_t>(buffer->width) * bpp;
+  const size_t rowBytes = buffer->stride > 0 ? static_cast<size_t>(buffer->stride) : packedRow;
+  if (rowBytes < packedRow) {
+    return "Stride is smaller than a row";
+  }
+
+  // 所需字节数：YUV 额外包含 UV 平面
+  size_t required = rowBytes * static_cast<size_t>(buffer->height);
+  if (buffer->format == MNN::CV::YUV_NV21 || buffer->format == MNN::CV::YUV_NV12) {
+    required += rowBytes * static_cast<size_t>((buffer->height + 1) / 2);
+  }
+
+  jsi::Value bufferValue = frame.getProperty(rt, "buffer");
+  if (bufferValue.isObject() && bufferValue.asObject(rt).isArrayBuffer(rt)) {
+    jsi::ArrayBuffer arrayBuffer = bufferValue.asObject(rt).getArrayBuffer(rt);
+    if (arrayBuffer.size(rt) < required) {
+      return "Buffer is smaller than width/height/stride require";
+    }
+    buffer->data = arrayBuffer.data(rt);
+    return "";
+  }
+
+  // 原生指针用字符串传递，避免 number 丢失高位（Android 指针带 tag）
+  jsi::Value pointerValue = frame.getProperty(rt, "pointer");
+  if (pointerValue.isString()) {
+    std::string pointerStr = pointerValue.asString(rt).utf8(rt);
+    uintptr_t address = 0;
+    try {
+      address = static_cast<uintptr_t>(std::stoull(pointerStr, nullptr, 0));
+    } catch (const std::exception&) {
+    }
+    if (address == 0) {
+      return "Invalid pointer: " + pointerStr;
+    }
+    buffer->data = reinterpret_cast<const uint8_t*>(address);
+    return "";
+  }
+
+  return "Frame needs either an ArrayBuffer 'buffer' or a 'pointer'";
+}
+
+} // namespace
+
 NativeSampleModule::NativeSampleModule(std::shared_ptr<CallInvoker> jsInvoker)
     : NativeSampleModuleCxxSpec(std::move(jsInvoker))
     , detectorInitialized_(false) {
-  // 创建人脸检测器实例
-  faceDetector_ = std::make_unique<NativeFaceDetector>();
-#ifdef __ANDROID__
-  LOGI("NativeSampleModule created (Android)");
-#else
-  LOGI("NativeSampleModule created (iOS)");
-#endif
+  // 单个工作线程：异步调用按提交顺序执行（检测器的第二个 session 留给 JS 线程上的同步检测）
+  workerPool_ = std::make_unique<WorkerPool>(1);
+  LOGI("NativeSampleModule created (" PLATFORM_NAME ")");
 }
 
 NativeSampleModule::~NativeSampleModule() {
-#ifdef __ANDROID__
-  LOGI("NativeSampleModule destroyed (Android)");
-#else
-  LOGI("NativeSampleModule destroyed (iOS)");
-#endif
+  // 扫描线程访问 resultCache_，先于成员析构结束它们
+  {
+    std::lock_guard<std::mutex> lock(scanMutex_);
+    scans_.clear();
+  }
+  LOGI("NativeSampleModule destroyed (" PLATFORM_NAME ")");
 }
 
 jsi::String NativeSampleModule::reverseString(jsi::Runtime& rt, jsi::String input) {
@@ -58,187 +483,637 @@ double NativeSampleModule::addNumbers(jsi::Runtime& rt, double a, double b) {
   return a + b;
 }
 
-#ifdef __ANDROID__
-jsi::String NativeSampleModule::initFaceDetector(jsi::Runtime& rt) {
-  LOGI("initFaceDetector called (Android)");
-
-  // 从 JNI 获取模型路径
-  const char* modelPath = getModelPath();
-  if (modelPath == nullptr) {
-    LOGE("Model path not set. Make sure ModelExtractor.getModelPath() was called.");
-    std::string error = R"({"error":"Model path not available. Please restart the app."})";
-    return jsi::String::createFromUtf8(rt, error);
+jsi::String NativeSampleModule::initFaceDetector(jsi::Runtime& rt,
+                                                 std::optional<jsi::Object> options) {
+  LOGI("initFaceDetector called (" PLATFORM_NAME ")");
+  DetectorInitOptions detectorOptions;
+  if (options) {
+    std::string parseError = parseDetectorOptions(rt, *options, &detectorOptions);
+    if (!parseError.empty()) {
+      LOGE("initFaceDetector: %s", parseError.c_str());
+      return jsi::String::createFromUtf8(rt, errorJson(parseError));
+    }
   }
 
-  std::string pathStr(modelPath);
-  LOGI("Model path: %s", pathStr.c_str());
+  std::unique_lock<std::shared_mutex> lock(detectorMutex_);
+  return jsi::String::createFromUtf8(rt, initDetectorLocked(detectorOptions));
+}
 
-  // 检查文件是否存在
-  std::ifstream file(pathStr);
-  if (!file.good()) {
-    LOGE("Model file does not exist: %s", pathStr.c_str());
-    std::string error = "{\"error\":\"Model file not found: " + pathStr + "\"}";
-    return jsi::String::createFromUtf8(rt, error);
+jsi::String NativeSampleModule::detectFace(jsi::Runtime& rt, jsi::String imagePath) {
+  std::string pathStr = imagePath.utf8(rt);
+  LOGD("detectFace called (" PLATFORM_NAME ") with path: %s", pathStr.c_str());
+  std::shared_lock<std::shared_mutex> lock(detectorMutex_);
+  return jsi::String::createFromUtf8(rt, detectFaceJsonLocked(pathStr));
+}
+
+jsi::String NativeSampleModule::detectFaceInBuffer(jsi::Runtime& rt, jsi::Object frame) {
+  PixelBuffer buffer;
+  std::string parseError = parsePixelFrame(rt, frame, &buffer);
+  if (!parseError.empty()) {
+    LOGE("detectFaceInBuffer: %s", parseError.c_str());
+    return jsi::String::createFromUtf8(rt, errorJson(parseError));
   }
-  file.close();
 
-  // 初始化检测器
-  int ret = faceDetector_->init(pathStr);
-  if (ret != 0) {
-    LOGE("Failed to initialize face detector, error code: %d", ret);
-    std::string error = "{\"error\":\"Failed to initialize detector\",\"code\":" + std::to_string(ret) + "}";
+  std::shared_lock<std::shared_mutex> lock(detectorMutex_);
+  std::vector<FaceInfo> faces;
+  std::string error = detectBufferLocked(buffer, &faces);
+  if (!error.empty()) {
     return jsi::String::createFromUtf8(rt, error);
   }
+  ScopedPerfTimer timer(PerfStage::Serialize);
+  return jsi::String::createFromUtf8(rt, facesToJson(faces));
+}
 
-  detectorInitialized_ = true;
-  LOGI("Face detector initialized successfully (Android)");
+jsi::Object NativeSampleModule::detectFaceTyped(jsi::Runtime& rt, jsi::String imagePath,
+                                                bool packed) {
+  std::string pathStr = imagePath.utf8(rt);
+  std::vector<FaceInfo> faces;
+  std::string error;
+  {
+    std::shared_lock<std::shared_mutex> lock(detectorMutex_);
+    error = detectFaceLocked(pathStr, &faces);
+  }
+  if (!error.empty()) {
+    throw jsi::JSError(rt, error);
+  }
+  ScopedPerfTimer timer(PerfStage::Serialize);
+  return facesToJsi(rt, faces, packed);
+}
+
+jsi::Object NativeSampleModule::detectFaceInBufferTyped(jsi::Runtime& rt, jsi::Object frame,
+                                                        bool packed) {
+  PixelBuffer buffer;
+  std::string parseError = parsePixelFrame(rt, frame, &buffer);
+  if (!parseError.empty()) {
+    throw jsi::JSError(rt, errorJson(parseError));
+  }
 
-  std::string result = "{\"status\":\"success\",\"message\":\"Detector initialized (Android)\"}";
-  return jsi::String::createFromUtf8(rt, result);
+  std::vector<FaceInfo> faces;
+  std::string error;
+  {
+    std::shared_lock<std::shared_mutex> lock(detectorMutex_);
+    error = detectBufferLocked(buffer, &faces);
+  }
+  if (!error.empty()) {
+    throw jsi::JSError(rt, error);
+  }
+  ScopedPerfTimer timer(PerfStage::Serialize);
+  return facesToJsi(rt, faces, packed);
 }
 
-jsi::String NativeSampleModule::detectFace(jsi::Runtime& rt, jsi::String imagePath) {
+AsyncPromise<std::string> NativeSampleModule::initFaceDetectorAsync(
+    jsi::Runtime& rt, std::optional<jsi::Object> options) {
+  LOGI("initFaceDetectorAsync called (" PLATFORM_NAME ")");
+  DetectorInitOptions detectorOptions;
+  std::string parseError;
+  if (options) {
+    parseError = parseDetectorOptions(rt, *options, &detectorOptions);
+  }
+  if (!parseError.empty()) {
+    LOGE("initFaceDetectorAsync: %s", parseError.c_str());
+    std::string error = errorJson(parseError);
+    return runAsync(rt, false, [error] { return error; });
+  }
+  return runAsync(rt, true, [this, detectorOptions] { return initDetectorLocked(detectorOptions); });
+}
+
+AsyncPromise<std::string> NativeSampleModule::detectFaceAsync(jsi::Runtime& rt,
+                                                              jsi::String imagePath) {
   std::string pathStr = imagePath.utf8(rt);
+  LOGD("detectFaceAsync called (" PLATFORM_NAME ") with path: %s", pathStr.c_str());
+  return runAsync(rt, false, [this, pathStr] { return detectFaceJsonLocked(pathStr); });
+}
+
+double NativeSampleModule::cancelPendingDetections(jsi::Runtime& rt) {
+  int cancelled = workerPool_->cancelAll();
+  LOGI("Cancelled %d pending calls", cancelled);
+  return cancelled;
+}
 
-  LOGI("detectFace called (Android) with path: %s", pathStr.c_str());
+AsyncPromise<std::string> NativeSampleModule::detectFaceTiledAsync(
+    jsi::Runtime& rt, jsi::String imagePath, std::optional<jsi::Object> options) {
+  std::string pathStr = imagePath.utf8(rt);
+  LOGD("detectFaceTiledAsync called (" PLATFORM_NAME ") with path: %s", pathStr.c_str());
+  TileConfig config;
+  if (options) {
+    parseTileOptions(rt, *options, &config);
+  }
+  return runAsync(rt, false, [this, pathStr, config] { return detectTiledLocked(pathStr, config); });
+}
 
-  // 检查检测器是否已初始化
+jsi::String NativeSampleModule::scanImages(jsi::Runtime& rt, jsi::Array paths,
+                                           jsi::Function onProgress,
+                                           std::optional<jsi::Object> options) {
+  ScanConfig config;
+  if (options && !parseScanOptions(rt, *options, &config)) {
+    LOGE("scanImages: invalid options");
+    return jsi::String::createFromUtf8(rt, R"({"error":"Invalid scan options","code":10003})");
+  }
+  std::vector<std::string> pathList;
+  pathList.reserve(paths.size(rt));
+  for (size_t i = 0; i < paths.size(rt); i++) {
+    pathList.push_back(paths.getValueAtIndex(rt, i).asString(rt).utf8(rt));
+  }
+
+  // 取当前的检测器和参数；扫描持有检测器的引用，不再需要 detectorMutex_
+  std::unique_ptr<ScanPipeline> scan;
+  {
+    std::shared_lock<std::shared_mutex> lock(detectorMutex_);
+    if (!detectorInitialized_) {
+      LOGE("Face detector not initialized");
+      return jsi::String::createFromUtf8(
+          rt, R"({"error":"Detector not initialized. Call initFaceDetector first."})");
+    }
+    config.input = inputConfig_;
+    scan = std::make_unique<ScanPipeline>(faceDetector_, config);
+    if (cacheResults_) {
+      scan->setCache(&resultCache_, resultConfigHash_, cacheContentHash_);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(scanMutex_);
+  for (auto it = scans_.begin(); it != scans_.end();) {
+    ScanState state = it->second->state();
+    it = state == ScanState::Done || state == ScanState::Cancelled ? scans_.erase(it)
+                                                                    : std::next(it);
+  }
+  const int jobId = nextScanId_++;
+  const size_t total = pathList.size();
+  AsyncCallback<std::string> callback(rt, std::move(onProgress), jsInvoker_);
+  scan->start(std::move(pathList), [jobId, callback](ScanProgress&& progress) {
+    callback.call(scanProgressToJson(jobId, progress));
+  });
+  scans_[jobId] = std::move(scan);
+  LOGI("scanImages: job %d started with %zu images", jobId, total);
+  return jsi::String::createFromUtf8(
+      rt, "{\"jobId\":" + std::to_string(jobId) + ",\"total\":" + std::to_string(total) + "}");
+}
+
+bool NativeSampleModule::pauseScan(jsi::Runtime& rt, double jobId) {
+  std::lock_guard<std::mutex> lock(scanMutex_);
+  ScanPipeline* scan = findScanLocked(jobId);
+  if (scan != nullptr) {
+    scan->pause();
+  }
+  return scan != nullptr;
+}
+
+bool NativeSampleModule::resumeScan(jsi::Runtime& rt, double jobId) {
+  std::lock_guard<std::mutex> lock(scanMutex_);
+  ScanPipeline* scan = findScanLocked(jobId);
+  if (scan != nullptr) {
+    scan->resume();
+  }
+  return scan != nullptr;
+}
+
+bool NativeSampleModule::cancelScan(jsi::Runtime& rt, double jobId) {
+  std::lock_guard<std::mutex> lock(scanMutex_);
+  ScanPipeline* scan = findScanLocked(jobId);
+  if (scan != nullptr) {
+    scan->cancel();
+  }
+  return scan != nullptr;
+}
+
+ScanPipeline* NativeSampleModule::findScanLocked(double jobId) {
+  int id = 0;
+  if (!toBoundedInt(jobId, INT32_MAX, &id)) {
+    return nullptr;
+  }
+  auto it = scans_.find(id);
+  if (it == scans_.end()) {
+    return nullptr;
+  }
+  ScanState state = it->second->state();
+  if (state == ScanState::Done || state == ScanState::Cancelled) {
+    return nullptr;
+  }
+  return it->second.get();
+}
+
+jsi::String NativeSampleModule::detectFaceInRegions(jsi::Runtime& rt, jsi::Object frame,
+                                                     jsi::Array regions,
+                                                     std::optional<double> expand) {
+  PixelBuffer buffer;
+  std::string parseError = parsePixelFrame(rt, frame, &buffer);
+  if (!parseError.empty()) {
+    LOGE("detectFaceInRegions: %s", parseError.c_str());
+    return jsi::String::createFromUtf8(rt, errorJson(parseError));
+  }
+
+  std::vector<FaceInfo> rois(regions.size(rt));
+  for (size_t i = 0; i < rois.size(); i++) {
+    jsi::Object box = regions.getValueAtIndex(rt, i).asObject(rt);
+    rois[i].x = static_cast<float>(box.getProperty(rt, "x").asNumber());
+    rois[i].y = static_cast<float>(box.getProperty(rt, "y").asNumber());
+    rois[i].width = static_cast<float>(box.getProperty(rt, "width").asNumber());
+    rois[i].height = static_cast<float>(box.getProperty(rt, "height").asNumber());
+    jsi::Value score = box.getProperty(rt, "score");
+    rois[i].score = score.isNumber() ? static_cast<float>(score.asNumber()) : 1.0f;
+  }
+  RegionConfig config;
+  if (expand.has_value()) {
+    config.expand = static_cast<float>(*expand);
+  }
+
+  std::shared_lock<std::shared_mutex> lock(detectorMutex_);
   if (!detectorInitialized_) {
     LOGE("Face detector not initialized");
-    std::string error = R"({"error":"Detector not initialized. Call initFaceDetector first."})";
-    return jsi::String::createFromUtf8(rt, error);
+    return jsi::String::createFromUtf8(
+        rt, R"({"error":"Detector not initialized. Call initFaceDetector first."})");
+  }
+  std::vector<FaceInfo> faces;
+  int ret = faceDetector_->detectInRegions(buffer, rois, &faces, config, nullptr, inputConfig_);
+  if (ret != 0) {
+    LOGE("Region detection failed, error code: %d", ret);
+    return jsi::String::createFromUtf8(
+        rt, "{\"error\":\"Detection failed\",\"code\":" + std::to_string(ret) + "}");
   }
+  return jsi::String::createFromUtf8(rt, facesToJson(faces));
+}
 
-  // 读取图像文件
-  cv::Mat image = cv::imread(pathStr);
-  if (image.empty()) {
-    LOGE("Failed to read image: %s", pathStr.c_str());
-    std::string error = R"({"error":"Failed to read image"})";
-    return jsi::String::createFromUtf8(rt, error);
+jsi::String NativeSampleModule::setFaceTrackerOptions(jsi::Runtime& rt,
+                                                       std::optional<jsi::Object> options) {
+  TrackerOptions trackerOptions;
+  if (options.has_value()) {
+    parseTrackerOptions(rt, *options, &trackerOptions);
+  }
+  if (!FaceTracker::validOptions(trackerOptions)) {
+    LOGE("Invalid tracker options");
+    return jsi::String::createFromUtf8(rt, R"({"error":"Invalid tracker options","code":10003})");
+  }
+  // 输入尺寸来自 init，跟踪器在下一帧按新参数重新创建
+  std::lock_guard<std::mutex> lock(trackerMutex_);
+  trackerOptions_ = trackerOptions;
+  faceTracker_.reset();
+  return jsi::String::createFromUtf8(rt, R"({"status":"success"})");
+}
+
+jsi::String NativeSampleModule::trackFacesInBuffer(jsi::Runtime& rt, jsi::Object frame) {
+  PixelBuffer buffer;
+  std::string parseError = parsePixelFrame(rt, frame, &buffer);
+  if (!parseError.empty()) {
+    LOGE("trackFacesInBuffer: %s", parseError.c_str());
+    return jsi::String::createFromUtf8(rt, errorJson(parseError));
   }
 
-  LOGI("Image loaded: %dx%d", image.cols, image.rows);
+  std::shared_lock<std::shared_mutex> lock(detectorMutex_);
+  if (!detectorInitialized_) {
+    LOGE("Face detector not initialized");
+    return jsi::String::createFromUtf8(
+        rt, R"({"error":"Detector not initialized. Call initFaceDetector first."})");
+  }
 
-  // 调用检测器
-  std::vector<FaceInfo> faces;
-  int ret = faceDetector_->detect(image, &faces);
+  std::lock_guard<std::mutex> trackerLock(trackerMutex_);
+  if (!faceTracker_) {
+    TrackerOptions trackerOptions = trackerOptions_;
+    trackerOptions.input = inputConfig_;
+    faceTracker_ = std::make_unique<FaceTracker>(faceDetector_, trackerOptions);
+  }
+  std::vector<TrackedFace> faces;
+  TrackProfile profile;
+  int ret = faceTracker_->process(buffer, &faces, &profile);
   if (ret != 0) {
-    LOGE("Detection failed, error code: %d", ret);
-    std::string error = "{\"error\":\"Detection failed\",\"code\":" + std::to_string(ret) + "}";
-    return jsi::String::createFromUtf8(rt, error);
+    LOGE("Tracking failed, error code: %d", ret);
+    return jsi::String::createFromUtf8(
+        rt, "{\"error\":\"Detection failed\",\"code\":" + std::to_string(ret) + "}");
   }
+  return jsi::String::createFromUtf8(rt, trackedToJson(faces, profile.detected));
+}
 
-  // 构建结果 JSON
-  std::string json = "{\"faces\":[";
-  for (size_t i = 0; i < faces.size(); i++) {
-    const FaceInfo& face = faces[i];
-    json += "{";
-    json += "\"x\":" + std::to_string(static_cast<int>(face.x)) + ",";
-    json += "\"y\":" + std::to_string(static_cast<int>(face.y)) + ",";
-    json += "\"width\":" + std::to_string(static_cast<int>(face.width)) + ",";
-    json += "\"height\":" + std::to_string(static_cast<int>(face.height)) + ",";
-    json += "\"score\":" + std::to_string(face.score);
-    json += "}";
-    if (i < faces.size() - 1) {
-      json += ",";
-    }
+void NativeSampleModule::setModelMemoryBudget(jsi::Runtime& rt, double megabytes) {
+  size_t bytes = megabytes > 0 ? static_cast<size_t>(megabytes * 1024 * 1024) : 0;
+  sharedModelRegistry().setBudget(bytes);
+  LOGI("Model memory budget set to %.1f MB", megabytes);
+}
+
+jsi::String NativeSampleModule::getResultCacheStats(jsi::Runtime& rt) {
+  ResultCache::Stats stats = resultCache_.stats();
+  std::string json = "{\"memoryHits\":" + std::to_string(stats.memoryHits) +
+                     ",\"diskHits\":" + std::to_string(stats.diskHits) +
+                     ",\"misses\":" + std::to_string(stats.misses) +
+                     ",\"memoryEntries\":" + std::to_string(stats.memoryEntries) +
+                     ",\"diskEntries\":" + std::to_string(stats.diskEntries) + "}";
+  return jsi::String::createFromUtf8(rt, json);
+}
+
+void NativeSampleModule::clearResultCache(jsi::Runtime& rt) {
+  resultCache_.clear();
+  LOGI("Result cache cleared");
+}
+
+jsi::String NativeSampleModule::getPerfStats(jsi::Runtime& rt) {
+  const PerfStats& stats = sharedPerfStats();
+  std::string json = "{\"stages\":{";
+  for (int i = 0; i < static_cast<int>(PerfStage::Count); i++) {
+    PerfStage stage = static_cast<PerfStage>(i);
+    LatencyHistogram::Summary summary = stats.summary(stage);
+    json += std::string(i > 0 ? "," : "") + "\"" + perfStageName(stage) + "\":{" +
+            "\"count\":" + std::to_string(summary.count) +
+            ",\"p50\":" + std::to_string(summary.p50Ms) +
+            ",\"p90\":" + std::to_string(summary.p90Ms) +
+            ",\"p99\":" + std::to_string(summary.p99Ms) +
+            ",\"max\":" + std::to_string(summary.maxMs) +
+            ",\"mean\":" + std::to_string(summary.meanMs) + "}";
   }
-  json += "]}";
+  json += "}}";
+  return jsi::String::createFromUtf8(rt, json);
+}
+
+void NativeSampleModule::resetPerfStats(jsi::Runtime& rt) {
+  sharedPerfStats().reset();
+  LOGI("Perf stats reset");
+}
+
+bool NativeSampleModule::setOpProfiling(jsi::Runtime& rt, bool enabled) {
+  std::shared_lock<std::shared_mutex> lock(detectorMutex_);
+  if (!detectorInitialized_) {
+    LOGE("Face detector not initialized");
+    return false;
+  }
+  faceDetector_->setOpProfiling(enabled);
+  LOGI("Operator profiling %s for model %s", enabled ? "enabled" : "disabled", modelId_.c_str());
+  return true;
+}
 
-  LOGI("Detection result: %zu faces detected", faces.size());
+jsi::String NativeSampleModule::getOpProfile(jsi::Runtime& rt, std::optional<double> topN) {
+  std::shared_lock<std::shared_mutex> lock(detectorMutex_);
+  if (!detectorInitialized_) {
+    LOGE("Face detector not initialized");
+    return jsi::String::createFromUtf8(
+        rt, R"({"error":"Detector not initialized. Call initFaceDetector first."})");
+  }
+  const size_t count = topN && *topN > 0 ? static_cast<size_t>(*topN) : 20;
+  OpReport report = faceDetector_->opReport();
+  LOGI("Operator profile (%s):\n%s", modelId_.c_str(), formatOpReport(report, count).c_str());
+  return jsi::String::createFromUtf8(rt, opReportToJson(report, count));
+}
+
+jsi::String NativeSampleModule::getModelStats(jsi::Runtime& rt) {
+  ModelRegistry::Stats stats = sharedModelRegistry().stats();
+  std::string loaded;
+  for (const auto& id : stats.loaded) {
+    loaded += (loaded.empty() ? "\"" : ",\"") + jsonEscape(id) + "\"";
+  }
+  std::string json = "{\"budgetMb\":" + std::to_string(stats.budgetBytes / 1048576.0) +
+                     ",\"residentMb\":" + std::to_string(stats.residentBytes / 1048576.0) +
+                     ",\"loaded\":[" + loaded + "]" +
+                     ",\"hits\":" + std::to_string(stats.hits) +
+                     ",\"loads\":" + std::to_string(stats.loads) +
+                     ",\"evictions\":" + std::to_string(stats.evictions) + "}";
   return jsi::String::createFromUtf8(rt, json);
 }
-#else
-// iOS 实现
-jsi::String NativeSampleModule::initFaceDetector(jsi::Runtime& rt) {
-  LOGI("initFaceDetector called (iOS)");
-
-  // 从 iOSModelLoader 获取模型路径
-  const char* modelPath = getIOSModelPath();
-  if (modelPath == nullptr) {
-    LOGE("Model path not set. Make sure iOSModelLoader.setModelPath() was called in AppDelegate.");
-    std::string error = R"({"error":"Model path not available. Please restart the app."})";
-    return jsi::String::createFromUtf8(rt, error);
+
+AsyncPromise<std::string> NativeSampleModule::runAsync(jsi::Runtime& rt, bool exclusive,
+                                                       std::function<std::string()> job) {
+  AsyncPromise<std::string> promise(rt, jsInvoker_);
+  workerPool_->submit(
+      [this, promise, exclusive, job = std::move(job)]() mutable {
+        try {
+          std::string result;
+          if (exclusive) {
+            std::unique_lock<std::shared_mutex> lock(detectorMutex_);
+            result = job();
+          } else {
+            std::shared_lock<std::shared_mutex> lock(detectorMutex_);
+            result = job();
+          }
+          promise.resolve(result);
+        } catch (const std::exception& e) {
+          LOGE("Async call failed: %s", e.what());
+          promise.reject(Error(e.what()));
+        }
+      },
+      [promise]() mutable { promise.reject(Error("Cancelled")); });
+  return promise;
+}
+
+std::string NativeSampleModule::initDetectorLocked(const DetectorInitOptions& options) {
+  // 默认模型（Android: APK asset 名，iOS: bundle 中的路径），其他模型与它位于同一目录
+  const char* defaultModel = platformModelName();
+  if (defaultModel == nullptr) {
+    LOGE("Model not set. " MODEL_PATH_HINT);
+    return R"({"error":"Model path not available. Please restart the app."})";
   }
 
-  std::string pathStr(modelPath);
-  LOGI("Model path: %s", pathStr.c_str());
+  // 复用已加载的检测器时不会再经过 init() 的参数校验，输入尺寸在这里检查
+  if (options.detector.inputWidth < 2 || options.detector.inputHeight < 2) {
+    LOGE("Invalid detector options");
+    return R"({"error":"Invalid detector options","code":10003})";
+  }
 
-  // 检查文件是否存在
-  std::ifstream file(pathStr);
-  if (!file.good()) {
-    LOGE("Model file does not exist: %s", pathStr.c_str());
-    std::string error = "{\"error\":\"Model file not found: " + pathStr + "\"}";
-    return jsi::String::createFromUtf8(rt, error);
+  std::string modelId = options.model.empty() ? modelIdFromFile(defaultModel) : options.model;
+  std::string modelFile = modelFileForId(defaultModel, modelId);
+  LOGI("Model: %s (%s)", modelId.c_str(), modelFile.c_str());
+
+  ModelSpec spec;
+  spec.open = [modelFile] { return openPlatformModel(modelFile.c_str()); };
+  // 模型缓冲在 session 创建后释放（releaseModelAfterInit 默认为 true），不常驻堆内存，
+  // 之后不能再为新尺寸创建 session。因此每种输入尺寸在注册表中是单独的一项（见下方
+  // registryKey），切换回已加载的尺寸时直接复用
+  spec.options = options.detector;
+  // 两个 session：工作线程上的异步检测不会阻塞 JS 线程上的同步检测（如相机帧）
+  spec.sessionCount = 2;
+
+  // 自动调优：读取保存的结果，没有时在参考图像上调优并保存
+  std::string tuneJson;
+  if (options.autoTune) {
+    cv::Mat reference = cv::imread(options.tuneImagePath);
+    if (reference.empty()) {
+      LOGE("Failed to read tuning image: %s", options.tuneImagePath.c_str());
+      return R"({"error":"Failed to read tuning image"})";
+    }
+    // 模型数据只在调优期间使用
+    std::unique_ptr<ModelSource> model = spec.open();
+    if (!model) {
+      LOGE("Failed to open model: %s", modelFile.c_str());
+      return "{\"error\":\"" + jsonEscape("Model file not found: " + modelFile) + "\",\"code\":10004}";
+    }
+    DetectorTuner tuner(platformCacheDir());
+    TuneResult tuned;
+    int ret = tuner.tune(*model, reference, spec.options, &tuned);
+    if (ret != 0) {
+      LOGE("Auto-tune failed, error code: %d", ret);
+      return "{\"error\":\"Auto-tune failed\",\"code\":" + std::to_string(ret) + "}";
+    }
+    spec.options = tuned.options;
+    spec.filter = tuned.filter;
+    tuneJson = ",\"tuned\":{\"numThreads\":" + std::to_string(tuned.options.numThreads) +
+               ",\"precision\":" + std::to_string(tuned.options.precision) +
+               ",\"filter\":" + std::to_string(tuned.filter) +
+               ",\"detectMs\":" + std::to_string(tuned.detectMs) +
+               ",\"cached\":" + (tuned.fromCache ? "true" : "false") + "}";
   }
-  file.close();
 
-  // 初始化检测器
-  int ret = faceDetector_->init(pathStr);
-  if (ret != 0) {
+  // 模型缓冲释放后不能再创建 session：扫描默认批大小的批量 session 在 init 中创建
+  // （调优之后设置，调优时不必创建），其他批大小的扫描逐张推理
+  spec.options.batchSizes = {ScanConfig().batchSize};
+
+  // 结果缓存的配置哈希：模型内容 + 影响检测结果的参数（含调优选出的精度和滤波器）
+  uint64_t configHash = 0;
+  if (options.cacheResults) {
+    if (std::unique_ptr<ModelSource> model = spec.open()) {
+      configHash = ResultCache::hashBytes(model->data(), model->size());
+    }
+    char params[128];
+    snprintf(params, sizeof(params), "%dx%d|%d|%g|%g|%d|%d|%d", spec.options.inputWidth,
+             spec.options.inputHeight, options.letterbox, spec.options.scoreThreshold,
+             spec.options.iouThreshold, spec.options.maxFaces, spec.options.precision,
+             spec.filter);
+    configHash = ResultCache::hashBytes(params, strlen(params), configHash);
+  }
+
+  // 从注册表取检测器：已加载且参数相同时直接复用，否则（重新）加载。
+  // 键为 "模型id@宽x高"，不同尺寸各占一项，按内存预算一起淘汰
+  const std::string registryKey = modelId + "@" + std::to_string(options.detector.inputWidth) +
+                                  "x" + std::to_string(options.detector.inputHeight);
+  ModelRegistry& registry = sharedModelRegistry();
+  registry.add(registryKey, std::move(spec));
+  uint64_t loadsBefore = registry.stats().loads;
+  int ret = 0;
+  std::shared_ptr<NativeFaceDetector> detector = registry.acquire(registryKey, &ret);
+  bool reused = registry.stats().loads == loadsBefore;
+  if (ret == 10003) {
+    LOGE("Invalid detector options");
+    return R"({"error":"Invalid detector options","code":10003})";
+  }
+  if (ret == 10004) {
+    LOGE("Failed to open model: %s", modelFile.c_str());
+    return "{\"error\":\"" + jsonEscape("Model file not found: " + modelFile) + "\",\"code\":10004}";
+  }
+  if (!detector) {
     LOGE("Failed to initialize face detector, error code: %d", ret);
-    std::string error = "{\"error\":\"Failed to initialize detector\",\"code\":" + std::to_string(ret) + "}";
-    return jsi::String::createFromUtf8(rt, error);
+    return "{\"error\":\"Failed to initialize detector\",\"code\":" + std::to_string(ret) + "}";
   }
 
+  // 之前的检测器若已不在注册表中，这里释放最后一个引用；
+  // 跟踪器持有旧检测器和旧输入尺寸，下一帧按新的重新创建
+  {
+    std::lock_guard<std::mutex> trackerLock(trackerMutex_);
+    faceTracker_.reset();
+  }
+  faceDetector_ = std::move(detector);
+  modelId_ = modelId;
+  // 输入尺寸即 init 尺寸，detect() 使用 init 时创建的 session；letterbox 按次传入
+  inputConfig_.width = options.detector.inputWidth;
+  inputConfig_.height = options.detector.inputHeight;
+  inputConfig_.letterbox = options.letterbox;
+  cacheResults_ = options.cacheResults;
+  cacheContentHash_ = options.cacheContentHash;
+  resultConfigHash_ = configHash;
+  std::string cacheDir = platformCacheDir();
+  if (cacheResults_ && !cacheDir.empty()) {
+    resultCache_.setDirectory(cacheDir + "/face_results");
+  }
   detectorInitialized_ = true;
-  LOGI("Face detector initialized successfully (iOS)");
+  LOGI("Face detector initialized successfully (" PLATFORM_NAME "), model %s%s",
+       modelId.c_str(), reused ? " (reused)" : "");
 
-  std::string result = "{\"status\":\"success\",\"message\":\"Detector initialized (iOS)\"}";
-  return jsi::String::createFromUtf8(rt, result);
+  return "{\"status\":\"success\",\"message\":\"Detector initialized (" PLATFORM_NAME ")\"" +
+         std::string(",\"model\":\"") + modelId + "\",\"reused\":" + (reused ? "true" : "false") +
+         tuneJson + "}";
 }
 
-jsi::String NativeSampleModule::detectFace(jsi::Runtime& rt, jsi::String imagePath) {
-  std::string pathStr = imagePath.utf8(rt);
-
-  LOGI("detectFace called (iOS) with path: %s", pathStr.c_str());
+std::string NativeSampleModule::detectFaceJsonLocked(const std::string& pathStr) {
+  std::vector<FaceInfo> faces;
+  std::string error = detectFaceLocked(pathStr, &faces);
+  if (!error.empty()) {
+    return error;
+  }
+  ScopedPerfTimer timer(PerfStage::Serialize);
+  return facesToJson(faces);
+}
 
+std::string NativeSampleModule::detectFaceLocked(const std::string& pathStr,
+                                                 std::vector<FaceInfo>* faces) {
+  ScopedPerfTimer timer(PerfStage::Request);
   // 检查检测器是否已初始化
   if (!detectorInitialized_) {
     LOGE("Face detector not initialized");
-    std::string error = R"({"error":"Detector not initialized. Call initFaceDetector first."})";
-    return jsi::String::createFromUtf8(rt, error);
+    return R"({"error":"Detector not initialized. Call initFaceDetector first."})";
   }
 
-  // 读取图像文件
-  cv::Mat image = cv::imread(pathStr);
-  if (image.empty()) {
+  // 同一文件、同一配置的结果直接从缓存返回，不再解码和推理
+  uint64_t cacheKey = 0;
+  const bool cacheable = cacheResults_ &&
+      ResultCache::makeKey(pathStr, resultConfigHash_, cacheContentHash_, &cacheKey);
+  if (cacheable && resultCache_.get(cacheKey, faces)) {
+    return "";
+  }
+
+  // 读取图像文件：JPEG 按模型输入尺寸缩小解码，不产生随后就被缩小丢弃的全尺寸像素
+  const int inputWidth = inputConfig_.width > 0 ? inputConfig_.width
+                                                : faceDetector_->options().inputWidth;
+  const int inputHeight = inputConfig_.height > 0 ? inputConfig_.height
+                                                  : faceDetector_->options().inputHeight;
+  LoadedImage loaded;
+  if (!loadImageForDetection(pathStr, inputWidth, inputHeight, &loaded)) {
     LOGE("Failed to read image: %s", pathStr.c_str());
-    std::string error = R"({"error":"Failed to read image"})";
-    return jsi::String::createFromUtf8(rt, error);
+    return R"({"error":"Failed to read image"})";
   }
 
-  LOGI("Image loaded: %dx%d", image.cols, image.rows);
+  LOGD("Image loaded: %dx%d (decoded 1/%d)", loaded.originalWidth, loaded.originalHeight,
+       loaded.sampleSize);
 
   // 调用检测器
-  std::vector<FaceInfo> faces;
-  int ret = faceDetector_->detect(image, &faces);
+  int ret = faceDetector_->detect(loaded.image, faces, nullptr, inputConfig_);
   if (ret != 0) {
     LOGE("Detection failed, error code: %d", ret);
-    std::string error = "{\"error\":\"Detection failed\",\"code\":" + std::to_string(ret) + "}";
-    return jsi::String::createFromUtf8(rt, error);
+    return "{\"error\":\"Detection failed\",\"code\":" + std::to_string(ret) + "}";
   }
 
-  // 构建结果 JSON
-  std::string json = "{\"faces\":[";
-  for (size_t i = 0; i < faces.size(); i++) {
-    const FaceInfo& face = faces[i];
-    json += "{";
-    json += "\"x\":" + std::to_string(static_cast<int>(face.x)) + ",";
-    json += "\"y\":" + std::to_string(static_cast<int>(face.y)) + ",";
-    json += "\"width\":" + std::to_string(static_cast<int>(face.width)) + ",";
-    json += "\"height\":" + std::to_string(static_cast<int>(face.height)) + ",";
-    json += "\"score\":" + std::to_string(face.score);
-    json += "}";
-    if (i < faces.size() - 1) {
-      json += ",";
-    }
+  // 坐标映射回原图
+  for (FaceInfo& face : *faces) {
+    face.x *= loaded.scaleX;
+    face.y *= loaded.scaleY;
+    face.width *= loaded.scaleX;
+    face.height *= loaded.scaleY;
+  }
+  if (cacheable) {
+    resultCache_.put(cacheKey, *faces);
   }
-  json += "]}";
 
-  LOGI("Detection result (iOS): %zu faces detected", faces.size());
-  return jsi::String::createFromUtf8(rt, json);
+  LOGD("Detection result (" PLATFORM_NAME "): %zu faces detected", faces->size());
+  return "";
+}
+
+std::string NativeSampleModule::detectTiledLocked(const std::string& pathStr,
+                                                  const TileConfig& config) {
+  if (!detectorInitialized_) {
+    LOGE("Face detector not initialized");
+    return R"({"error":"Detector not initialized. Call initFaceDetector first."})";
+  }
+
+  cv::Mat image = cv::imread(pathStr);
+  if (image.empty()) {
+    LOGE("Failed to read image: %s", pathStr.c_str());
+    return R"({"error":"Failed to read image"})";
+  }
+
+  std::vector<FaceInfo> faces;
+  int ret = faceDetector_->detectTiled(image, &faces, config, nullptr, inputConfig_);
+  if (ret != 0) {
+    LOGE("Tiled detection failed, error code: %d", ret);
+    return "{\"error\":\"Detection failed\",\"code\":" + std::to_string(ret) + "}";
+  }
+  return facesToJson(faces);
+}
+
+std::string NativeSampleModule::detectBufferLocked(const PixelBuffer& buffer,
+                                                   std::vector<FaceInfo>* faces) {
+  ScopedPerfTimer timer(PerfStage::Request);
+  if (!detectorInitialized_) {
+    LOGE("Face detector not initialized");
+    return R"({"error":"Detector not initialized. Call initFaceDetector first."})";
+  }
+
+  int ret = faceDetector_->detect(buffer, faces, nullptr, inputConfig_);
+  if (ret != 0) {
+    LOGE("Detection failed, error code: %d", ret);
+    return "{\"error\":\"Detection failed\",\"code\":" + std::to_string(ret) + "}";
+  }
+  return "";
 }
-#endif
 
 } // namespace facebook::react
@@ -2,11 +2,35 @@
 
 #include <AppSpecsJSI.h>
 #include <jsi/jsi.h>
+#include <atomic>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include "FaceTracker.h"
+#include "ModelRegistry.h"
 #include "NativeFaceDetector.h"
+#include "ResultCache.h"
+#include "ScanPipeline.h"
+#include "WorkerPool.h"
 
 namespace facebook::react {
 
+// JS 传入的初始化参数
+struct DetectorInitOptions {
+  std::string model;          // 模型 id（不含 .mnn 的文件名），空表示平台默认模型
+  DetectorOptions detector;
+  bool autoTune = false;      // 使用（或生成）保存的自动调优结果
+  std::string tuneImagePath;  // 自动调优的参考图像
+  bool letterbox = false;     // 保持宽高比缩放到输入尺寸，不拉伸
+  bool cacheResults = true;   // detectFace* 按图像文件缓存结果（内存 + 磁盘）
+  bool cacheContentHash = false;  // 缓存键使用文件内容哈希而不是路径 + 修改时间
+};
+
 class NativeSampleModule : public NativeSampleModuleCxxSpec<NativeSampleModule> {
 public:
   NativeSampleModule(std::shared_ptr<CallInvoker> jsInvoker);
@@ -14,12 +38,110 @@ public:
 
   jsi::String reverseString(jsi::Runtime& rt, jsi::String input);
   double addNumbers(jsi::Runtime& rt, double a, double b);
-  jsi::String initFaceDetector(jsi::Runtime& rt);  // 无需传参数，自动从加载的模型
+  // 模型自动从加载的路径读取；options 见 specs/NativeSampleModule.ts 中的 DetectorOptions，
+  // 省略时使用默认参数
+  jsi::String initFaceDetector(jsi::Runtime& rt, std::optional<jsi::Object> options);
   jsi::String detectFace(jsi::Runtime& rt, jsi::String imagePath);
 
+  // 直接检测像素缓冲区（相机帧），frame 见 specs/NativeSampleModule.ts 中的 PixelFrame。
+  // ArrayBuffer 在调用期间直接读取，不做拷贝
+  jsi::String detectFaceInBuffer(jsi::Runtime& rt, jsi::Object frame);
+
+  // 与上面两个接口相同，但直接返回 JS 对象，省去 JSON 拼接和 JSON.parse：
+  // packed 为 false 返回 {x, y, width, height, score} 数组，为 true 返回
+  // [x, y, w, h, score, ...] 形式的 Float32Array。出错时抛出 JS 异常，message 为错误 JSON
+  jsi::Object detectFaceTyped(jsi::Runtime& rt, jsi::String imagePath, bool packed);
+  jsi::Object detectFaceInBufferTyped(jsi::Runtime& rt, jsi::Object frame, bool packed);
+
+  // 异步接口：在后台线程执行，结果通过 jsInvoker_ 回到 JS 线程。
+  // 所有异步调用按调用顺序执行并 resolve；cancelPendingDetections 会 reject
+  // 尚未开始的调用并返回其数量，正在执行的调用不受影响
+  AsyncPromise<std::string> initFaceDetectorAsync(jsi::Runtime& rt,
+                                                  std::optional<jsi::Object> options);
+  AsyncPromise<std::string> detectFaceAsync(jsi::Runtime& rt, jsi::String imagePath);
+  double cancelPendingDetections(jsi::Runtime& rt);
+
+  // 大图分块检测（见 NativeFaceDetector::detectTiled），options 见 TileOptions
+  AsyncPromise<std::string> detectFaceTiledAsync(jsi::Runtime& rt, jsi::String imagePath,
+                                                 std::optional<jsi::Object> options);
+
+  // 批量扫描图库（见 ScanPipeline）：立即返回 {"jobId", "total"}，结果分批通过 onProgress
+  // 回到 JS 线程，最后一次的 state 为 "done" 或 "cancelled"。options 见 ScanOptions。
+  // 扫描使用开始时的检测器和参数，之后的 init 不影响它
+  jsi::String scanImages(jsi::Runtime& rt, jsi::Array paths, jsi::Function onProgress,
+                         std::optional<jsi::Object> options);
+  // 暂停 / 继续 / 取消扫描；jobId 不存在或扫描已结束时返回 false
+  bool pauseScan(jsi::Runtime& rt, double jobId);
+  bool resumeScan(jsi::Runtime& rt, double jobId);
+  bool cancelScan(jsi::Runtime& rt, double jobId);
+
+  // 在 regions（{x, y, width, height, score} 数组）附近的区域内检测，见
+  // NativeFaceDetector::detectInRegions；expand 省略时为 2
+  jsi::String detectFaceInRegions(jsi::Runtime& rt, jsi::Object frame, jsi::Array regions,
+                                  std::optional<double> expand);
+
+  // 视频模式：options 见 specs/NativeSampleModule.ts 中的 TrackerOptions。
+  // 跟踪器有状态，所有 trackFacesInBuffer 调用共用一个，按调用顺序串行执行
+  jsi::String setFaceTrackerOptions(jsi::Runtime& rt, std::optional<jsi::Object> options);
+  jsi::String trackFacesInBuffer(jsi::Runtime& rt, jsi::Object frame);
+
+  // 模型注册表（进程内所有模块实例共享）：内存预算和状态
+  void setModelMemoryBudget(jsi::Runtime& rt, double megabytes);
+  jsi::String getModelStats(jsi::Runtime& rt);
+
+  // 检测结果缓存：命中 / 未命中计数和条目数；清空内存和磁盘中的所有结果
+  jsi::String getResultCacheStats(jsi::Runtime& rt);
+  void clearResultCache(jsi::Runtime& rt);
+
+  // 各阶段耗时直方图（进程内所有检测累计，见 PerfStats）：每个阶段的次数和
+  // p50 / p90 / p99 / max / mean（毫秒）；reset 清零所有阶段
+  jsi::String getPerfStats(jsi::Runtime& rt);
+  void resetPerfStats(jsi::Runtime& rt);
+
+  // 当前检测器的逐算子计时（见 OpProfiler）：开启时清空之前的统计，检测器未初始化时返回 false。
+  // getOpProfile 返回按类型汇总和耗时最高的 topN（默认 20）个算子的 JSON，并把同样的表格写入日志
+  bool setOpProfiling(jsi::Runtime& rt, bool enabled);
+  jsi::String getOpProfile(jsi::Runtime& rt, std::optional<double> topN);
+
 private:
-  std::unique_ptr<NativeFaceDetector> faceDetector_;
-  bool detectorInitialized_;
+  // 同步与异步接口共用的实现，返回 JSON 字符串；调用方需持有 detectorMutex_
+  // （init 需独占锁，检测只需共享锁，检测器内部的 session 池保证并发安全）
+  std::string initDetectorLocked(const DetectorInitOptions& options);
+  std::string detectFaceJsonLocked(const std::string& imagePath);
+
+  // 检测并把结果写入 faces，成功返回空串，失败返回错误 JSON；调用方需持有 detectorMutex_
+  std::string detectFaceLocked(const std::string& imagePath, std::vector<FaceInfo>* faces);
+  std::string detectBufferLocked(const PixelBuffer& buffer, std::vector<FaceInfo>* faces);
+  std::string detectTiledLocked(const std::string& imagePath, const TileConfig& config);
+
+  // 已结束返回 nullptr；调用方需持有 scanMutex_
+  ScanPipeline* findScanLocked(double jobId);
+
+  // 把 job 放到工作线程执行，job 的返回值用于 resolve；exclusive 表示需要独占检测器
+  AsyncPromise<std::string> runAsync(jsi::Runtime& rt, bool exclusive,
+                                     std::function<std::string()> job);
+
+  // 当前模型的检测器，由 ModelRegistry 加载并共享；注册表淘汰它之后仍由这里持有到切换模型
+  std::shared_ptr<NativeFaceDetector> faceDetector_;
+  std::string modelId_;
+  InputConfig inputConfig_;  // 每次检测的输入尺寸和 letterbox，来自最近一次 init
+  // detectFace* 的结果缓存；configHash 覆盖模型内容和影响结果的参数，来自最近一次 init
+  ResultCache resultCache_;
+  uint64_t resultConfigHash_ = 0;
+  bool cacheResults_ = false;
+  bool cacheContentHash_ = false;
+  // 视频模式的跟踪器，首次 trackFacesInBuffer 时用当前检测器创建；init 切换检测器时丢弃
+  std::unique_ptr<FaceTracker> faceTracker_;
+  TrackerOptions trackerOptions_;
+  std::mutex trackerMutex_;
+  std::atomic<bool> detectorInitialized_;
+  std::shared_mutex detectorMutex_;  // 同步接口与工作线程共用检测器
+  // scanImages 启动的扫描，结束后在下一次 scanImages 时移除；析构时取消并等待
+  std::map<int, std::unique_ptr<ScanPipeline>> scans_;
+  int nextScanId_ = 1;
+  std::mutex scanMutex_;
+  // 最后声明，保证最先析构：先停止工作线程，再释放它们访问的成员
+  std::unique_ptr<WorkerPool> workerPool_;
 };
 
 } // namespace facebook::react
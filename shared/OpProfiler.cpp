@@ -0,0 +1,167 @@
+#include "OpProfiler.h"
+#include "JsonUtil.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace facebook::react {
+
+namespace {
+
+// 每次推理的平均耗时和 GFLOP/s（MFLOP / ms 即 GFLOP/s）
+double perRunMs(double totalMs, uint64_t runs) {
+    return runs > 0 ? totalMs / runs : 0;
+}
+
+double gflops(double totalMflops, double totalMs) {
+    return totalMs > 0 ? totalMflops / totalMs : 0;
+}
+
+double share(double ms, double totalMs) {
+    return totalMs > 0 ? ms / totalMs : 0;
+}
+
+} // namespace
+
+MNN::ErrorCode OpProfiler::run(const MNN::Interpreter& interpreter, const MNN::Session* session) {
+    using Clock = std::chrono::steady_clock;
+    struct Sample {
+        std::string name;
+        std::string type;
+        float mflops;
+        double ms;
+    };
+    // 同一 session 的算子依次执行，记录本次推理的样本，结束后统一合并
+    std::vector<Sample> samples;
+    Clock::time_point start;
+    MNN::TensorCallBackWithInfo before = [&](const std::vector<MNN::Tensor*>&,
+                                             const MNN::OperatorInfo*) {
+        start = Clock::now();
+        return true;  // 返回 false 会跳过该算子
+    };
+    MNN::TensorCallBackWithInfo after = [&](const std::vector<MNN::Tensor*>&,
+                                            const MNN::OperatorInfo* info) {
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        samples.push_back({info->name(), info->type(), info->flops(), ms});
+        return true;
+    };
+    // sync：GPU 等异步后端在每个算子结束时等待完成，计时才对应该算子
+    MNN::ErrorCode code = interpreter.runSessionWithCallBackInfo(session, before, after, true);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const Sample& sample = samples[i];
+        // 没有名称的算子按类型和执行位置区分
+        const std::string name = sample.name.empty()
+            ? sample.type + "#" + std::to_string(i) : sample.name;
+        auto it = index_.find(name);
+        if (it == index_.end()) {
+            it = index_.emplace(name, ops_.size()).first;
+            OpStat stat;
+            stat.name = name;
+            stat.type = sample.type;
+            ops_.push_back(std::move(stat));
+        }
+        OpStat& stat = ops_[it->second];
+        ++stat.calls;
+        stat.totalMs += sample.ms;
+        stat.totalMflops += sample.mflops;
+    }
+    ++runs_;
+    return code;
+}
+
+OpReport OpProfiler::report() const {
+    OpReport report;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        report.runs = runs_;
+        report.ops = ops_;
+    }
+    std::unordered_map<std::string, size_t> typeIndex;
+    for (const OpStat& op : report.ops) {
+        report.totalMs += op.totalMs;
+        auto it = typeIndex.find(op.type);
+        if (it == typeIndex.end()) {
+            it = typeIndex.emplace(op.type, report.types.size()).first;
+            report.types.push_back(OpTypeStat{op.type});
+        }
+        OpTypeStat& type = report.types[it->second];
+        ++type.ops;
+        type.totalMs += op.totalMs;
+        type.totalMflops += op.totalMflops;
+    }
+    std::sort(report.ops.begin(), report.ops.end(),
+              [](const OpStat& a, const OpStat& b) { return a.totalMs > b.totalMs; });
+    std::sort(report.types.begin(), report.types.end(),
+              [](const OpTypeStat& a, const OpTypeStat& b) { return a.totalMs > b.totalMs; });
+    return report;
+}
+
+void OpProfiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ops_.clear();
+    index_.clear();
+    runs_ = 0;
+}
+
+std::string formatOpReport(const OpReport& report, size_t topN) {
+    std::string text;
+    char line[192];
+    snprintf(line, sizeof(line), "%llu runs, %.3f ms/run in operators\n",
+             static_cast<unsigned long long>(report.runs), perRunMs(report.totalMs, report.runs));
+    text += line;
+    snprintf(line, sizeof(line), "%-24s %5s %10s %7s %9s\n", "type", "ops", "ms/run", "share",
+             "GFLOP/s");
+    text += line;
+    for (const OpTypeStat& type : report.types) {
+        snprintf(line, sizeof(line), "%-24s %5d %10.3f %6.1f%% %9.2f\n", type.type.c_str(),
+                 type.ops, perRunMs(type.totalMs, report.runs),
+                 100.0 * share(type.totalMs, report.totalMs),
+                 gflops(type.totalMflops, type.totalMs));
+        text += line;
+    }
+    snprintf(line, sizeof(line), "\n%-32s %-20s %10s %7s %9s %9s\n", "op", "type", "ms/run",
+             "share", "MFLOP", "GFLOP/s");
+    text += line;
+    for (size_t i = 0; i < report.ops.size() && i < topN; ++i) {
+        const OpStat& op = report.ops[i];
+        snprintf(line, sizeof(line), "%-32.32s %-20.20s %10.3f %6.1f%% %9.2f %9.2f\n",
+                 op.name.c_str(), op.type.c_str(), perRunMs(op.totalMs, report.runs),
+                 100.0 * share(op.totalMs, report.totalMs),
+                 op.calls > 0 ? op.totalMflops / op.calls : 0,
+                 gflops(op.totalMflops, op.totalMs));
+        text += line;
+    }
+    return text;
+}
+
+std::string opReportToJson(const OpReport& report, size_t topN) {
+    // 算子名称和类型名来自模型文件，可能含任意字符，拼入前转义
+    std::string json = "{\"runs\":" + std::to_string(report.runs) +
+                       ",\"totalMs\":" + std::to_string(perRunMs(report.totalMs, report.runs)) +
+                       ",\"types\":[";
+    for (size_t i = 0; i < report.types.size(); ++i) {
+        const OpTypeStat& type = report.types[i];
+        json += std::string(i > 0 ? "," : "") + "{\"type\":\"" + jsonEscape(type.type) + "\"" +
+                ",\"ops\":" + std::to_string(type.ops) +
+                ",\"ms\":" + std::to_string(perRunMs(type.totalMs, report.runs)) +
+                ",\"share\":" + std::to_string(share(type.totalMs, report.totalMs)) +
+                ",\"gflops\":" + std::to_string(gflops(type.totalMflops, type.totalMs)) + "}";
+    }
+    json += "],\"ops\":[";
+    for (size_t i = 0; i < report.ops.size() && i < topN; ++i) {
+        const OpStat& op = report.ops[i];
+        json += std::string(i > 0 ? "," : "") + "{\"name\":\"" + jsonEscape(op.name) + "\"" +
+                ",\"type\":\"" + jsonEscape(op.type) + "\"" +
+                ",\"ms\":" + std::to_string(perRunMs(op.totalMs, report.runs)) +
+                ",\"share\":" + std::to_string(share(op.totalMs, report.totalMs)) +
+                ",\"mflops\":" + std::to_string(op.calls > 0 ? op.totalMflops / op.calls : 0) +
+                ",\"gflops\":" + std::to_string(gflops(op.totalMflops, op.totalMs)) + "}";
+    }
+    json += "]}";
+    return json;
+}
+
+} // namespace facebook::react
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <MNN/Interpreter.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace facebook::react {
+
+// 单个算子（按名称）的累计统计
+struct OpStat {
+    std::string name;
+    std::string type;
+    uint64_t calls = 0;
+    double totalMs = 0;
+    double totalMflops = 0;  // 所有调用的计算量之和（百万次浮点运算，来自 MNN 的估计）
+};
+
+// 同一类型所有算子的累计统计
+struct OpTypeStat {
+    std::string type;
+    int ops = 0;  // 该类型的算子个数
+    double totalMs = 0;
+    double totalMflops = 0;
+};
+
+struct OpReport {
+    uint64_t runs = 0;     // 统计的推理次数
+    double totalMs = 0;    // 所有算子耗时之和（不含算子之间的调度开销）
+    std::vector<OpStat> ops;        // 按耗时从高到低
+    std::vector<OpTypeStat> types;  // 按耗时从高到低
+};
+
+// 逐算子计时：run() 代替 Interpreter::runSession，用 runSessionWithCallBackInfo 在
+// 每个算子前后各取一次时间，按算子名称累计。每个算子多两次回调和一次 map 查找，
+// 只用于分析，不用于线上检测。多个线程可以同时 run()（各自的 session）
+class OpProfiler {
+public:
+    MNN::ErrorCode run(const MNN::Interpreter& interpreter, const MNN::Session* session);
+
+    OpReport report() const;
+    void reset();
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<OpStat> ops_;  // 按首次执行的顺序
+    std::unordered_map<std::string, size_t> index_;
+    uint64_t runs_ = 0;
+};
+
+// 文本表格：按类型汇总，再列出耗时最高的 topN 个算子（每行：耗时占比、平均 ms、GFLOP/s）
+std::string formatOpReport(const OpReport& report, size_t topN);
+
+// JSON：{runs, totalMs, types: [{type, ops, ms, share, gflops}], ops: [{name, type, ms, share,
+// mflops, gflops}]}，ms 为每次推理的平均值，ops 只含耗时最高的 topN 个
+std::string opReportToJson(const OpReport& report, size_t topN);
+
+} // namespace facebook::react
@@ -0,0 +1,119 @@
+#include "PerfStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace facebook::react {
+
+namespace {
+
+constexpr int kFirstOctave = 5;  // 2^5 = kLinearBuckets
+
+static_assert(1 << kFirstOctave == LatencyHistogram::kLinearBuckets,
+              "linear range must end at the first octave");
+
+} // namespace
+
+const char* perfStageName(PerfStage stage) {
+    switch (stage) {
+        case PerfStage::ImageLoad: return "imageLoad";
+        case PerfStage::Resize: return "resize";
+        case PerfStage::Convert: return "convert";
+        case PerfStage::Inference: return "inference";
+        case PerfStage::OutputCopy: return "outputCopy";
+        case PerfStage::AnchorDecode: return "anchorDecode";
+        case PerfStage::Nms: return "nms";
+        case PerfStage::Detect: return "detect";
+        case PerfStage::Serialize: return "serialize";
+        case PerfStage::Request: return "request";
+        case PerfStage::Count: break;
+    }
+    return "unknown";
+}
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+int LatencyHistogram::bucketFor(uint64_t us) {
+    if (us < static_cast<uint64_t>(kLinearBuckets)) {
+        return static_cast<int>(us);
+    }
+    // 最高位所在的 2 的幂区间，区间内按紧随其后的 4 位细分
+    const int octave = 63 - __builtin_clzll(us);
+    if (octave - kFirstOctave >= kOctaves) {
+        return kBuckets - 1;
+    }
+    const int sub = static_cast<int>((us >> (octave - 4)) & (kSubBuckets - 1));
+    return kLinearBuckets + (octave - kFirstOctave) * kSubBuckets + sub;
+}
+
+double LatencyHistogram::bucketValueUs(int bucket) {
+    if (bucket < kLinearBuckets) {
+        return bucket;
+    }
+    const int octave = (bucket - kLinearBuckets) / kSubBuckets + kFirstOctave;
+    const int sub = (bucket - kLinearBuckets) % kSubBuckets;
+    const double width = std::ldexp(1.0, octave - 4);
+    return (kSubBuckets + sub) * width + 0.5 * width;
+}
+
+void LatencyHistogram::record(double ms) {
+    const uint64_t us = ms > 0 ? static_cast<uint64_t>(ms * 1000.0 + 0.5) : 0;
+    buckets_[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    sumUs_.fetch_add(us, std::memory_order_relaxed);
+    uint64_t max = maxUs_.load(std::memory_order_relaxed);
+    while (us > max && !maxUs_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Summary LatencyHistogram::summary() const {
+    uint64_t counts[kBuckets];
+    Summary summary;
+    for (int i = 0; i < kBuckets; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        summary.count += counts[i];
+    }
+    if (summary.count == 0) {
+        return summary;
+    }
+    const double maxUs = static_cast<double>(maxUs_.load(std::memory_order_relaxed));
+    summary.maxMs = maxUs / 1000.0;
+    summary.meanMs = sumUs_.load(std::memory_order_relaxed) / 1000.0 / summary.count;
+
+    // 按累计计数找到各分位所在的桶，取桶的代表值（不超过最大值）
+    const double percentiles[] = {0.5, 0.9, 0.99};
+    double* outputs[] = {&summary.p50Ms, &summary.p90Ms, &summary.p99Ms};
+    uint64_t cumulative = 0;
+    int next = 0;
+    for (int i = 0; i < kBuckets && next < 3; ++i) {
+        cumulative += counts[i];
+        while (next < 3 &&
+               cumulative >= static_cast<uint64_t>(std::ceil(percentiles[next] * summary.count))) {
+            *outputs[next] = std::min(bucketValueUs(i), maxUs) / 1000.0;
+            ++next;
+        }
+    }
+    return summary;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sumUs_.store(0, std::memory_order_relaxed);
+    maxUs_.store(0, std::memory_order_relaxed);
+}
+
+void PerfStats::reset() {
+    for (auto& histogram : histograms_) {
+        histogram.reset();
+    }
+}
+
+PerfStats& sharedPerfStats() {
+    static PerfStats stats;
+    return stats;
+}
+
+} // namespace facebook::react
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace facebook::react {
+
+// 统计耗时的阶段
+enum class PerfStage : int {
+    ImageLoad,     // 读取并解码图像文件（loadImageForDetection）
+    Resize,        // 以下同 DetectProfile，来自 NativeFaceDetector::detect()
+    Convert,
+    Inference,
+    OutputCopy,
+    AnchorDecode,
+    Nms,
+    Detect,        // 整个 detect() 调用
+    Serialize,     // 结果转成 JSON / JS 对象
+    Request,       // 模块的一次检测请求（含缓存查询、加载、检测，不含序列化）
+    Count
+};
+
+// JSON 中使用的阶段名
+const char* perfStageName(PerfStage stage);
+
+// 无锁耗时直方图（HDR 风格的对数-线性分桶，单位微秒）：
+// 32 µs 以下每微秒一个桶，之后每个 2 的幂区间分 16 个桶，相对误差不超过 1/16，
+// 上限约 19 小时。record() 只做几次 relaxed 原子操作，可在任意线程并发调用；
+// summary() 与并发的 record() / reset() 之间不保证是同一时刻的快照
+class LatencyHistogram {
+public:
+    struct Summary {
+        uint64_t count = 0;
+        double p50Ms = 0;
+        double p90Ms = 0;
+        double p99Ms = 0;
+        double maxMs = 0;
+        double meanMs = 0;
+    };
+
+    static constexpr int kLinearBuckets = 32;
+    static constexpr int kSubBuckets = 16;
+    static constexpr int kOctaves = 32;
+    static constexpr int kBuckets = kLinearBuckets + kOctaves * kSubBuckets;
+
+    LatencyHistogram();
+
+    void record(double ms);
+    Summary summary() const;
+    void reset();
+
+    // 微秒值所在的桶，以及桶所代表的值（区间中点）
+    static int bucketFor(uint64_t us);
+    static double bucketValueUs(int bucket);
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets];
+    std::atomic<uint64_t> sumUs_;
+    std::atomic<uint64_t> maxUs_;
+};
+
+// 各阶段的直方图
+class PerfStats {
+public:
+    void record(PerfStage stage, double ms) {
+        histograms_[static_cast<int>(stage)].record(ms);
+    }
+
+    LatencyHistogram::Summary summary(PerfStage stage) const {
+        return histograms_[static_cast<int>(stage)].summary();
+    }
+
+    void reset();
+
+private:
+    LatencyHistogram histograms_[static_cast<int>(PerfStage::Count)];
+};
+
+// 进程内唯一的统计，检测器和模块都记录到这里
+PerfStats& sharedPerfStats();
+
+// 作用域计时：析构时把经过的时间记录到 sharedPerfStats() 的 stage
+class ScopedPerfTimer {
+public:
+    explicit ScopedPerfTimer(PerfStage stage)
+        : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedPerfTimer() {
+        sharedPerfStats().record(stage_, std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_).count());
+    }
+
+    ScopedPerfTimer(const ScopedPerfTimer&) = delete;
+    ScopedPerfTimer& operator=(const ScopedPerfTimer&) = delete;
+
+private:
+    PerfStage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace facebook::react
@@ -0,0 +1,330 @@
+#include "ResultCache.h"
+#include "MappedModel.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TAG "ResultCache"
+
+namespace facebook::react {
+
+namespace {
+
+// 文件头：魔数 + 人脸数
+constexpr char kMagic[4] = {'F', 'R', 'C', '1'};
+constexpr const char* kSuffix = ".faces";
+
+// FNV-1a 64 位哈希
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+template <typename T>
+uint64_t fnv1aValue(const T& value, uint64_t hash) {
+    return fnv1a(&value, sizeof(value), hash);
+}
+
+bool endsWith(const char* name, const char* suffix) {
+    size_t n = strlen(name);
+    size_t m = strlen(suffix);
+    return n >= m && strcmp(name + n - m, suffix) == 0;
+}
+
+// 以下函数只访问文件系统，在锁外调用
+
+std::string filePath(const std::string& dir, uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 "%s", key, kSuffix);
+    return dir + "/" + name;
+}
+
+size_t countFiles(const std::string& dir) {
+    size_t count = 0;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(d)) {
+            if (endsWith(entry->d_name, kSuffix)) {
+                ++count;
+            }
+        }
+        closedir(d);
+    }
+    return count;
+}
+
+bool readFile(const std::string& path, std::vector<FaceInfo>* faces) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    uint32_t count = 0;
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        !file.read(reinterpret_cast<char*>(&count), sizeof(count)) || count > 100000) {
+        return false;
+    }
+    std::vector<FaceInfo> loaded(count);
+    for (FaceInfo& face : loaded) {
+        float values[5];
+        if (!file.read(reinterpret_cast<char*>(values), sizeof(values))) {
+            return false;
+        }
+        face.x = values[0];
+        face.y = values[1];
+        face.width = values[2];
+        face.height = values[3];
+        face.score = values[4];
+    }
+    *faces = std::move(loaded);
+    return true;
+}
+
+// 先写临时文件再改名，进程中途退出不会留下不完整的结果。
+// 写入成功返回 true，existed 表示是否覆盖了已有文件
+bool writeFile(const std::string& path, const std::string& tmpPath,
+               const std::vector<FaceInfo>& faces, bool* existed) {
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        uint32_t count = static_cast<uint32_t>(faces.size());
+        file.write(kMagic, sizeof(kMagic));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (const FaceInfo& face : faces) {
+            const float values[5] = {face.x, face.y, face.width, face.height, face.score};
+            file.write(reinterpret_cast<const char*>(values), sizeof(values));
+        }
+        if (!file.good()) {
+            LOGE("Failed to write cache file: %s", tmpPath.c_str());
+            unlink(tmpPath.c_str());
+            return false;
+        }
+    }
+    struct stat st;
+    *existed = stat(path.c_str(), &st) == 0;
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// 按修改时间删除最旧的文件，直到只剩 keep 个，返回剩余文件数
+size_t pruneDirectory(const std::string& dir, size_t keep) {
+    std::vector<std::pair<int64_t, std::string>> files;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(d)) {
+            if (!endsWith(entry->d_name, kSuffix)) {
+                continue;
+            }
+            std::string path = dir + "/" + entry->d_name;
+            struct stat st;
+            if (stat(path.c_str(), &st) == 0) {
+                files.emplace_back(static_cast<int64_t>(st.st_mtime), std::move(path));
+            }
+        }
+        closedir(d);
+    }
+    std::sort(files.begin(), files.end());
+    size_t removed = 0;
+    for (size_t i = 0; i + keep < files.size(); ++i) {
+        unlink(files[i].second.c_str());
+        ++removed;
+    }
+    LOGI("Pruned %zu cache files, %zu left", removed, files.size() - removed);
+    return files.size() - removed;
+}
+
+} // namespace
+
+ResultCache::ResultCache(size_t memoryCapacity, size_t diskCapacity)
+    : memoryCapacity_(std::max<size_t>(1, memoryCapacity)),
+      diskCapacity_(std::max<size_t>(1, diskCapacity)) {}
+
+void ResultCache::setDirectory(const std::string& dir) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (dir == dir_) {
+            return;
+        }
+    }
+    // 创建目录和统计已有文件在锁外进行
+    std::string usable = dir;
+    size_t entries = 0;
+    if (!dir.empty()) {
+        if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+            LOGE("Failed to create cache directory: %s", dir.c_str());
+            usable.clear();
+        } else {
+            entries = countFiles(dir);
+            LOGI("Result cache directory: %s (%zu entries)", dir.c_str(), entries);
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    dir_ = usable;
+    diskEntries_ = entries;
+    ++generation_;
+}
+
+uint64_t ResultCache::hashBytes(const void* data, size_t size, uint64_t seed) {
+    return fnv1a(data, size, seed);
+}
+
+bool ResultCache::makeKey(const std::string& path, uint64_t configHash, bool contentHash,
+                          uint64_t* key) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    uint64_t hash = fnv1aValue(configHash, 14695981039346656037ull);
+    hash = fnv1aValue(static_cast<int64_t>(st.st_size), hash);
+    if (contentHash) {
+        // 内容相同即命中，与路径和修改时间无关
+        MappedModel file;
+        if (!file.map(path)) {
+            return false;
+        }
+        *key = fnv1a(file.data(), file.size(), hash);
+        return true;
+    }
+#if defined(__APPLE__)
+    const timespec& mtime = st.st_mtimespec;
+#else
+    const timespec& mtime = st.st_mtim;
+#endif
+    hash = fnv1aValue(static_cast<int64_t>(mtime.tv_sec), hash);
+    hash = fnv1aValue(static_cast<int64_t>(mtime.tv_nsec), hash);
+    *key = fnv1a(path.data(), path.size(), hash);
+    return true;
+}
+
+bool ResultCache::get(uint64_t key, std::vector<FaceInfo>* faces) {
+    std::string dir;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            *faces = it->second->second;
+            ++memoryHits_;
+            return true;
+        }
+        if (dir_.empty()) {
+            ++misses_;
+            return false;
+        }
+        dir = dir_;
+        generation = generation_;
+    }
+
+    std::vector<FaceInfo> loaded;
+    bool found = readFile(filePath(dir, key), &loaded);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!found) {
+        ++misses_;
+        return false;
+    }
+    // 读文件期间缓存被清空或换了目录时，结果照常返回但不再放入内存层
+    if (generation == generation_) {
+        insertLocked(key, loaded);
+    }
+    ++diskHits_;
+    *faces = std::move(loaded);
+    return true;
+}
+
+void ResultCache::put(uint64_t key, const std::vector<FaceInfo>& faces) {
+    std::string dir;
+    std::string tmpPath;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        insertLocked(key, faces);
+        if (dir_.empty()) {
+            return;
+        }
+        dir = dir_;
+        tmpPath = filePath(dir, key) + "." + std::to_string(++writeSerial_) + ".tmp";
+    }
+
+    bool existed = false;
+    if (!writeFile(filePath(dir, key), tmpPath, faces, &existed) || existed) {
+        return;
+    }
+    {
+        // 超出容量时由写入的线程清理，只清理到容量的 3/4，避免每次写入都扫描目录
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (dir != dir_ || ++diskEntries_ <= diskCapacity_ || pruning_) {
+            return;
+        }
+        pruning_ = true;
+    }
+    size_t left = pruneDirectory(dir, diskCapacity_ * 3 / 4);
+    std::lock_guard<std::mutex> lock(mutex_);
+    pruning_ = false;
+    if (dir == dir_) {
+        diskEntries_ = left;
+    }
+}
+
+void ResultCache::clear() {
+    std::string dir;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lru_.clear();
+        index_.clear();
+        memoryHits_ = 0;
+        diskHits_ = 0;
+        misses_ = 0;
+        diskEntries_ = 0;
+        ++generation_;
+        dir = dir_;
+    }
+    if (dir.empty()) {
+        return;
+    }
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(d)) {
+            if (endsWith(entry->d_name, kSuffix)) {
+                unlink((dir + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(d);
+    }
+}
+
+ResultCache::Stats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.memoryHits = memoryHits_;
+    stats.diskHits = diskHits_;
+    stats.misses = misses_;
+    stats.memoryEntries = lru_.size();
+    stats.diskEntries = diskEntries_;
+    return stats;
+}
+
+void ResultCache::insertLocked(uint64_t key, const std::vector<FaceInfo>& faces) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->second = faces;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+    lru_.emplace_front(key, faces);
+    index_[key] = lru_.begin();
+    if (lru_.size() > memoryCapacity_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+} // namespace facebook::react
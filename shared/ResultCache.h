@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FaceInfo.h"
+
+namespace facebook::react {
+
+// 检测结果缓存（按图像文件和检测配置寻址）
+// - 内存层：最近使用的 memoryCapacity 条结果（LRU）
+// - 磁盘层：setDirectory() 之后每条结果另存为目录下一个小文件（<键>.faces，
+//   8 字节头 + 每个人脸 20 字节），应用重启后仍然有效；超过 diskCapacity 条时删除最旧的
+// 键由 makeKey() 根据文件路径、修改时间、大小（或文件内容）和调用方给出的配置哈希计算，
+// 图像文件被修改或检测配置改变后自然失效。所有方法线程安全：锁只保护内存层和计数，
+// 磁盘文件的读写、清理和目录扫描都在锁外进行，不会阻塞其他线程的内存层命中
+class ResultCache {
+public:
+    struct Stats {
+        uint64_t memoryHits = 0;
+        uint64_t diskHits = 0;
+        uint64_t misses = 0;
+        size_t memoryEntries = 0;
+        size_t diskEntries = 0;
+    };
+
+    explicit ResultCache(size_t memoryCapacity = 256, size_t diskCapacity = 4096);
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // 设置磁盘层目录（不存在时创建），空串表示只使用内存层
+    void setDirectory(const std::string& dir);
+
+    // 计算 path 的缓存键；contentHash 为 true 时对文件内容求哈希（移动 / 复制后的
+    // 同一张图也能命中，但每次需要读整个文件）。文件不存在时返回 false
+    static bool makeKey(const std::string& path, uint64_t configHash, bool contentHash,
+                        uint64_t* key);
+
+    // FNV-1a 64 位哈希，seed 用于串联多段数据；调用方可用它计算 configHash
+    static uint64_t hashBytes(const void* data, size_t size,
+                              uint64_t seed = 14695981039346656037ull);
+
+    // 依次查找内存层和磁盘层，磁盘层命中时提升到内存层；未命中返回 false
+    bool get(uint64_t key, std::vector<FaceInfo>* faces);
+
+    // 写入两层（磁盘层未设置时只写内存层）
+    void put(uint64_t key, const std::vector<FaceInfo>& faces);
+
+    // 清空两层，计数器归零
+    void clear();
+
+    Stats stats() const;
+
+private:
+    using Entry = std::pair<uint64_t, std::vector<FaceInfo>>;
+
+    // 调用方需持有 mutex_
+    void insertLocked(uint64_t key, const std::vector<FaceInfo>& faces);
+
+    mutable std::mutex mutex_;
+    size_t memoryCapacity_;
+    size_t diskCapacity_;
+    std::list<Entry> lru_;  // 最近使用的在前
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+    std::string dir_;
+    size_t diskEntries_ = 0;
+    // setDirectory() / clear() 时递增：锁外读到的磁盘结果若已过期则不放入内存层
+    uint64_t generation_ = 0;
+    uint64_t writeSerial_ = 0;  // 临时文件名序号，同一键的并发写入互不覆盖
+    bool pruning_ = false;      // 同时只有一个线程清理磁盘层
+    uint64_t memoryHits_ = 0;
+    uint64_t diskHits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+} // namespace facebook::react
@@ -0,0 +1,277 @@
+#include "ScanPipeline.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <climits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TAG "ScanPipeline"
+
+namespace facebook::react {
+
+namespace {
+
+// 提示内核把整个文件读入页缓存（异步，不等待），解码线程随后读取时不再阻塞在磁盘 I/O 上
+void prefetchFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+#if defined(__APPLE__)
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        radvisory advice;
+        advice.ra_offset = 0;
+        advice.ra_count = static_cast<int>(std::min<off_t>(st.st_size, INT_MAX));
+        fcntl(fd, F_RDADVISE, &advice);
+    }
+#else
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+    close(fd);
+}
+
+} // namespace
+
+ScanPipeline::ScanPipeline(std::shared_ptr<NativeFaceDetector> detector, const ScanConfig& config)
+    : detector_(std::move(detector)),
+      config_(config),
+      decodeQueue_(config.queueDepth),
+      inferQueue_(config.queueDepth),
+      resultQueue_(config.queueDepth) {
+    const DetectorOptions& options = detector_->options();
+    minWidth_ = config_.input.width > 0 ? config_.input.width : options.inputWidth;
+    minHeight_ = config_.input.height > 0 ? config_.input.height : options.inputHeight;
+    // detectBatch() 使用默认输入尺寸、直接拉伸；模型缓冲已释放时只有 init 创建过的批大小
+    // 能一次推理，否则每个满批次都会退回逐张推理，不如直接逐张
+    batchable_ = config_.batchSize > 1 && !config_.input.letterbox &&
+                 minWidth_ == options.inputWidth && minHeight_ == options.inputHeight &&
+                 detector_->supportsBatch(config_.batchSize);
+}
+
+ScanPipeline::~ScanPipeline() {
+    cancel();
+    wait();
+}
+
+void ScanPipeline::setCache(ResultCache* cache, uint64_t configHash, bool contentHash) {
+    cache_ = cache;
+    configHash_ = configHash;
+    contentHash_ = contentHash;
+}
+
+void ScanPipeline::start(std::vector<std::string> paths, ProgressFn onProgress) {
+    paths_ = std::move(paths);
+    onProgress_ = std::move(onProgress);
+
+    int decodeThreads = config_.decodeThreads;
+    if (decodeThreads <= 0) {
+        decodeThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    }
+    const int inferThreads = std::max(1, config_.inferThreads);
+    decodersLeft_ = decodeThreads;
+    inferersLeft_ = inferThreads;
+    LOGI("Scanning %zu images: %d decode threads, %d inference threads, batch %d%s",
+         paths_.size(), decodeThreads, inferThreads, config_.batchSize,
+         batchable_ ? "" : " (per image)");
+
+    threads_.emplace_back(&ScanPipeline::ioStage, this);
+    for (int i = 0; i < decodeThreads; ++i) {
+        threads_.emplace_back(&ScanPipeline::decodeStage, this);
+    }
+    for (int i = 0; i < inferThreads; ++i) {
+        threads_.emplace_back(&ScanPipeline::inferStage, this);
+    }
+    threads_.emplace_back(&ScanPipeline::postStage, this);
+}
+
+void ScanPipeline::pause() {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    paused_ = true;
+}
+
+void ScanPipeline::resume() {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    paused_ = false;
+    pauseCv_.notify_all();
+}
+
+void ScanPipeline::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        if (cancelled_ || finished_) {
+            return;
+        }
+        cancelled_ = true;
+        pauseCv_.notify_all();
+    }
+    decodeQueue_.close(true);
+    inferQueue_.close(true);
+    resultQueue_.close(true);
+}
+
+void ScanPipeline::wait() {
+    for (std::thread& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+ScanState ScanPipeline::state() const {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    if (finished_) {
+        return cancelled_ ? ScanState::Cancelled : ScanState::Done;
+    }
+    return paused_ ? ScanState::Paused : ScanState::Running;
+}
+
+bool ScanPipeline::waitWhilePaused() {
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    pauseCv_.wait(lock, [this] { return !paused_ || cancelled_; });
+    return !cancelled_;
+}
+
+void ScanPipeline::ioStage() {
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        if (!waitWhilePaused()) {
+            break;
+        }
+        Item item;
+        item.index = i;
+        item.result.index = i;
+        if (cache_ != nullptr) {
+            item.cacheable = ResultCache::makeKey(paths_[i], configHash_, contentHash_,
+                                                  &item.cacheKey);
+            if (item.cacheable && cache_->get(item.cacheKey, &item.result.faces)) {
+                item.result.cached = true;
+                if (!resultQueue_.push(std::move(item))) {
+                    break;
+                }
+                continue;
+            }
+        }
+        prefetchFile(paths_[i]);
+        if (!decodeQueue_.push(std::move(item))) {
+            break;
+        }
+    }
+    decodeQueue_.close();
+}
+
+void ScanPipeline::decodeStage() {
+    Item item;
+    while (decodeQueue_.pop(&item) && waitWhilePaused()) {
+        if (!loadImageForDetection(paths_[item.index], minWidth_, minHeight_, &item.loaded)) {
+            LOGE("Failed to read image: %s", paths_[item.index].c_str());
+            item.result.error = 10001;
+            if (!resultQueue_.push(std::move(item))) {
+                break;
+            }
+            continue;
+        }
+        if (!inferQueue_.push(std::move(item))) {
+            break;
+        }
+    }
+    // 最后一个解码线程结束时，推理阶段不会再有新的输入
+    if (--decodersLeft_ == 0) {
+        inferQueue_.close();
+    }
+}
+
+void ScanPipeline::inferStage() {
+    const size_t batchSize = static_cast<size_t>(std::max(1, config_.batchSize));
+    std::vector<Item> batch;
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<FaceInfo>> batchFaces;
+    Item item;
+    bool open = true;
+    while (open && inferQueue_.pop(&item)) {
+        // 只取已经解码好的，不为凑满批次而等待
+        batch.clear();
+        batch.push_back(std::move(item));
+        while (batch.size() < batchSize && inferQueue_.tryPop(&item)) {
+            batch.push_back(std::move(item));
+        }
+        if (!waitWhilePaused()) {
+            break;
+        }
+
+        // 只有满批次走 detectBatch()，每个 slot 只需缓存一个批大小的 session
+        bool inferred = false;
+        if (batchable_ && batch.size() == batchSize) {
+            images.clear();
+            for (const Item& pending : batch) {
+                images.push_back(pending.loaded.image);
+            }
+            if (detector_->detectBatch(images, &batchFaces) == 0) {
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    batch[i].result.faces = std::move(batchFaces[i]);
+                }
+                inferred = true;
+            }
+        }
+        if (!inferred) {
+            for (Item& pending : batch) {
+                pending.result.error = detector_->detect(pending.loaded.image,
+                                                         &pending.result.faces, nullptr,
+                                                         config_.input);
+            }
+        }
+
+        for (Item& done : batch) {
+            done.loaded.image.release();  // 后处理只需要缩放比例
+            if (!resultQueue_.push(std::move(done))) {
+                open = false;
+                break;
+            }
+        }
+    }
+    if (--inferersLeft_ == 0) {
+        resultQueue_.close();
+    }
+}
+
+void ScanPipeline::postStage() {
+    ScanProgress progress;
+    progress.total = paths_.size();
+    const size_t interval = static_cast<size_t>(std::max(1, config_.progressInterval));
+    Item item;
+    while (resultQueue_.pop(&item)) {
+        ScanResult& result = item.result;
+        if (!result.cached && result.error == 0) {
+            for (FaceInfo& face : result.faces) {
+                face.x *= item.loaded.scaleX;
+                face.y *= item.loaded.scaleY;
+                face.width *= item.loaded.scaleX;
+                face.height *= item.loaded.scaleY;
+            }
+            if (item.cacheable) {
+                cache_->put(item.cacheKey, result.faces);
+            }
+        }
+        ++progress.processed;
+        progress.cached += result.cached ? 1 : 0;
+        progress.failed += result.error != 0 ? 1 : 0;
+        progress.results.push_back(std::move(result));
+        if (progress.results.size() >= interval && progress.processed < progress.total) {
+            onProgress_(ScanProgress(progress));
+            progress.results.clear();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        finished_ = true;
+        progress.state = cancelled_ ? ScanState::Cancelled : ScanState::Done;
+    }
+    LOGI("Scan %s: %zu/%zu images, %zu cached, %zu failed",
+         progress.state == ScanState::Done ? "finished" : "cancelled", progress.processed,
+         progress.total, progress.cached, progress.failed);
+    onProgress_(std::move(progress));
+}
+
+} // namespace facebook::react
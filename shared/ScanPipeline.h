@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FaceInfo.h"
+#include "ImageLoader.h"
+#include "NativeFaceDetector.h"
+#include "ResultCache.h"
+
+namespace facebook::react {
+
+// 有界阻塞队列：满时 push 等待，空时 pop 等待，用于流水线各阶段之间的背压。
+// close() 之后 push 返回 false，pop 取完剩余元素后返回 false；
+// close(true) 同时丢弃队列中的元素（取消时使用）
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    bool pop(T* item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        return takeLocked(item);
+    }
+
+    // 不等待：队列为空时直接返回 false
+    bool tryPop(T* item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return takeLocked(item);
+    }
+
+    void close(bool discard = false) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        if (discard) {
+            items_.clear();
+        }
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+
+private:
+    bool takeLocked(T* item) {
+        if (items_.empty()) {
+            return false;
+        }
+        *item = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+    std::deque<T> items_;
+    size_t capacity_;
+    bool closed_ = false;
+};
+
+// 批量扫描参数
+struct ScanConfig {
+    int decodeThreads = 0;      // 解码线程数，0 表示 CPU 核数的一半（至少 1）
+    int inferThreads = 1;       // 推理线程数，不超过检测器的 session 数才有意义
+    int batchSize = 4;          // 每次推理最多的图像数（取队列中已解码的，不等待凑满）
+    int queueDepth = 16;        // 各阶段之间队列的容量，限制已解码图像占用的内存
+    int progressInterval = 32;  // 每完成多少张报告一次进度，结束时总会报告
+    InputConfig input;          // 每次检测的输入尺寸和 letterbox
+};
+
+// 一张图像的结果，index 为它在 paths 中的位置
+struct ScanResult {
+    size_t index = 0;
+    std::vector<FaceInfo> faces;  // 原图坐标
+    int error = 0;                // 0 成功；10001 图像无法读取；其他为 detect() 的错误码
+    bool cached = false;          // 来自结果缓存
+};
+
+enum class ScanState { Running, Paused, Done, Cancelled };
+
+// 自上次报告以来完成的结果和累计计数
+struct ScanProgress {
+    ScanState state = ScanState::Running;
+    size_t processed = 0;
+    size_t total = 0;
+    size_t cached = 0;
+    size_t failed = 0;
+    std::vector<ScanResult> results;  // 按完成顺序，不一定按 index 顺序
+};
+
+// 图库批量扫描流水线，四个阶段由有界队列连接，各自在独立线程上运行：
+// 1. I/O（1 个线程）：计算缓存键并查询结果缓存，命中的直接交给第 4 阶段；
+//    未命中的文件提示内核预读（posix_fadvise / F_RDADVISE），解码线程读取时已在页缓存中
+// 2. 解码（decodeThreads 个线程）：loadImageForDetection 按模型输入尺寸缩小解码
+// 3. 推理（inferThreads 个线程）：取出队列中已解码的最多 batchSize 张图，
+//    默认输入配置下用 detectBatch() 一次推理，否则逐张 detect()
+// 4. 后处理（1 个线程）：坐标映射回原图、写入结果缓存、汇总并回调进度
+// 检测器由调用方共享持有，扫描期间切换模型不影响正在进行的扫描。
+// pause() 让前三个阶段在处理下一张图之前停下（已在队列中的图像仍会完成）；
+// cancel() 丢弃所有排队的图像，正在推理的批次完成后结束
+class ScanPipeline {
+public:
+    // 在后处理线程上串行调用；最后一次调用的 state 为 Done 或 Cancelled
+    using ProgressFn = std::function<void(ScanProgress&&)>;
+
+    ScanPipeline(std::shared_ptr<NativeFaceDetector> detector, const ScanConfig& config);
+    ~ScanPipeline();  // 取消并等待所有线程结束
+
+    ScanPipeline(const ScanPipeline&) = delete;
+    ScanPipeline& operator=(const ScanPipeline&) = delete;
+
+    // 使用结果缓存（需在 start() 之前调用），参数含义同 ResultCache::makeKey()
+    void setCache(ResultCache* cache, uint64_t configHash, bool contentHash);
+
+    // 启动扫描线程后立即返回；每个 ScanPipeline 只能启动一次
+    void start(std::vector<std::string> paths, ProgressFn onProgress);
+
+    void pause();
+    void resume();
+    void cancel();
+
+    // 等待所有线程结束（最后一次进度回调之后返回）
+    void wait();
+
+    ScanState state() const;
+
+private:
+    // 在各阶段之间传递的一张图像
+    struct Item {
+        size_t index = 0;
+        uint64_t cacheKey = 0;
+        bool cacheable = false;
+        LoadedImage loaded;
+        ScanResult result;
+    };
+
+    void ioStage();
+    void decodeStage();
+    void inferStage();
+    void postStage();
+
+    // 暂停时阻塞，已取消返回 false
+    bool waitWhilePaused();
+
+    std::shared_ptr<NativeFaceDetector> detector_;
+    ScanConfig config_;
+    int minWidth_;   // 解码后至少保留的尺寸（模型输入尺寸）
+    int minHeight_;
+    bool batchable_;  // 输入配置与 detectBatch() 一致，且检测器能一次推理该批大小
+
+    ResultCache* cache_ = nullptr;
+    uint64_t configHash_ = 0;
+    bool contentHash_ = false;
+
+    std::vector<std::string> paths_;
+    ProgressFn onProgress_;
+
+    BoundedQueue<Item> decodeQueue_;
+    BoundedQueue<Item> inferQueue_;
+    BoundedQueue<Item> resultQueue_;
+    std::atomic<int> decodersLeft_{0};
+    std::atomic<int> inferersLeft_{0};
+
+    mutable std::mutex stateMutex_;
+    std::condition_variable pauseCv_;
+    bool paused_ = false;
+    bool cancelled_ = false;
+    bool finished_ = false;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace facebook::react
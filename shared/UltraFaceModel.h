@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace facebook::react {
+
+// UltraFace 模型描述（编译期常量）
+// 所有 UltraFace 变体（slim / RFB）共用同一组 anchor 参数，anchors 只随输入尺寸变化；
+// 运行时的通用路径按任意输入尺寸用这些参数生成 anchors，
+// 输入尺寸固定的描述（如 UltraFaceRfb320）另外在编译期生成 anchor 表并特化解码。
+struct UltraFaceParams {
+    static constexpr int kNumLevels = 4;
+    static constexpr int kMaxMinBoxes = 3;
+    static constexpr float kStrides[kNumLevels] = {8.0f, 16.0f, 32.0f, 64.0f};
+    static constexpr int kNumMinBoxes[kNumLevels] = {3, 2, 2, 3};
+    static constexpr float kMinBoxes[kNumLevels][kMaxMinBoxes] = {
+        {10.0f, 16.0f, 24.0f},
+        {32.0f, 48.0f},
+        {64.0f, 96.0f},
+        {128.0f, 192.0f, 256.0f}
+    };
+    static constexpr float kCenterVariance = 0.1f;
+    static constexpr float kSizeVariance = 0.2f;
+    static constexpr float kMean[3] = {127.0f, 127.0f, 127.0f};
+    static constexpr float kNorm[3] = {1.0f / 128.0f, 1.0f / 128.0f, 1.0f / 128.0f};
+};
+
+// RFB-320 / slim-320 的默认输入：320x240，4420 个 anchor
+struct UltraFaceRfb320 : UltraFaceParams {
+    static constexpr int kInputWidth = 320;
+    static constexpr int kInputHeight = 240;
+};
+
+// 编译期 anchor 表（SoA 布局），数值与 generateAnchors() 逐位一致
+template <size_t N>
+struct FixedAnchorTable {
+    std::array<float, N> cx{};
+    std::array<float, N> cy{};
+    std::array<float, N> w{};
+    std::array<float, N> h{};
+
+    static constexpr size_t size() { return N; }
+};
+
+namespace ultraface_detail {
+
+// 整数 ceil(value / stride)，stride 为整数值的 float
+constexpr int gridSize(int value, float stride) {
+    int s = static_cast<int>(stride);
+    return (value + s - 1) / s;
+}
+
+constexpr float clip(float v, float hi) {
+    return v < 0 ? 0 : (v > hi ? hi : v);
+}
+
+} // namespace ultraface_detail
+
+// 输入尺寸为 Model::kInputWidth x kInputHeight 时的 anchor 数
+template <typename Model>
+constexpr size_t ultraFaceAnchorCount() {
+    size_t count = 0;
+    for (int i = 0; i < Model::kNumLevels; ++i) {
+        count += static_cast<size_t>(ultraface_detail::gridSize(Model::kInputWidth, Model::kStrides[i])) *
+                 ultraface_detail::gridSize(Model::kInputHeight, Model::kStrides[i]) *
+                 Model::kNumMinBoxes[i];
+    }
+    return count;
+}
+
+// 在编译期生成 anchors；遍历顺序与每一步的浮点运算都与 generateAnchors() 相同
+template <typename Model>
+constexpr FixedAnchorTable<ultraFaceAnchorCount<Model>()> makeFixedAnchors() {
+    using ultraface_detail::clip;
+    FixedAnchorTable<ultraFaceAnchorCount<Model>()> table;
+    const float width = static_cast<float>(Model::kInputWidth);
+    const float height = static_cast<float>(Model::kInputHeight);
+    size_t n = 0;
+    for (int i = 0; i < Model::kNumLevels; ++i) {
+        const float stride = Model::kStrides[i];
+        const int numX = ultraface_detail::gridSize(Model::kInputWidth, stride);
+        const int numY = ultraface_detail::gridSize(Model::kInputHeight, stride);
+        for (int y = 0; y < numY; ++y) {
+            for (int x = 0; x < numX; ++x) {
+                float centerX = (x + 0.5f) * stride / width;
+                float centerY = (y + 0.5f) * stride / height;
+                for (int k = 0; k < Model::kNumMinBoxes[i]; ++k) {
+                    float minBox = Model::kMinBoxes[i][k];
+                    table.cx[n] = clip(centerX, 1.0f);
+                    table.cy[n] = clip(centerY, 1.0f);
+                    table.w[n] = clip(minBox / width, 1.0f);
+                    table.h[n] = clip(minBox / height, 1.0f);
+                    ++n;
+                }
+            }
+        }
+    }
+    return table;
+}
+
+static_assert(ultraFaceAnchorCount<UltraFaceRfb320>() == 4420, "RFB-320 anchor count");
+
+} // namespace facebook::react
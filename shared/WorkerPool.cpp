@@ -0,0 +1,88 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+namespace facebook::react {
+
+WorkerPool::WorkerPool(int numThreads) {
+    numThreads = std::max(1, numThreads);
+    threads_.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        threads_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+uint64_t WorkerPool::submit(Task run, Task onCancel) {
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextId_++;
+        queue_.push_back({id, std::move(run), std::move(onCancel)});
+    }
+    cv_.notify_one();
+    return id;
+}
+
+bool WorkerPool::cancel(uint64_t id) {
+    Task onCancel;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = std::find_if(queue_.begin(), queue_.end(),
+                                 [id](const Job& job) { return job.id == id; });
+        if (iter == queue_.end()) {
+            return false;
+        }
+        onCancel = std::move(iter->onCancel);
+        queue_.erase(iter);
+    }
+    // 回调在锁外执行，允许其中再次提交任务
+    if (onCancel) onCancel();
+    return true;
+}
+
+int WorkerPool::cancelAll() {
+    std::deque<Job> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled.swap(queue_);
+    }
+    for (auto& job : cancelled) {
+        if (job.onCancel) job.onCancel();
+    }
+    return static_cast<int>(cancelled.size());
+}
+
+size_t WorkerPool::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void WorkerPool::workerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        job.run();
+    }
+}
+
+} // namespace facebook::react
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace facebook::react {
+
+// 后台工作线程池
+// - 任务按提交顺序（FIFO）出队
+// - 尚未开始执行的任务可以取消，取消时在调用 cancel 的线程上执行其 onCancel 回调
+// - 析构时直接丢弃排队任务（不调用 onCancel），并等待正在执行的任务结束
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkerPool(int numThreads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // 提交任务，返回任务编号（从 1 开始递增）
+    uint64_t submit(Task run, Task onCancel = nullptr);
+
+    // 取消一个排队中的任务；任务已开始或已完成时返回 false
+    bool cancel(uint64_t id);
+
+    // 取消所有排队中的任务，返回取消的数量
+    int cancelAll();
+
+    // 排队中（尚未开始）的任务数
+    size_t pending() const;
+
+private:
+    struct Job {
+        uint64_t id;
+        Task run;
+        Task onCancel;
+    };
+
+    void workerLoop();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> queue_;
+    std::vector<std::thread> threads_;
+    uint64_t nextId_ = 1;
+    bool stopping_ = false;
+};
+
+} // namespace facebook::react
@@ -1,10 +1,136 @@
 import {TurboModule, TurboModuleRegistry} from 'react-native';
 
+// 相机帧等原始像素缓冲区；buffer 与 pointer 二选一
+export type PixelFrame = {
+  buffer?: Object;   // ArrayBuffer
+  pointer?: string;  // 原生像素地址，如 "0x7b1f2a3000"（字符串避免 number 丢失高位）
+  width: number;
+  height: number;
+  stride?: number;   // 每行字节数（YUV 为 Y 平面），默认紧密排列
+  format: string;    // 'rgba' | 'bgra' | 'rgb' | 'bgr' | 'gray' | 'nv21' | 'nv12'
+};
+
+// 检测器参数，所有字段可选，省略时使用默认值
+export type DetectorOptions = {
+  // 模型 id，即 assets / app bundle 中的文件名（不含 .mnn），默认 'RFB-320'。
+  // 已加载的模型保留在原生注册表中，切换回来时无需重新加载（参数不变时）
+  model?: string;
+  numThreads?: number;      // 每个 session 的线程数，默认 2
+  precision?: string;       // 'normal' | 'high' | 'low'
+  memory?: string;          // 'normal' | 'high' | 'low'
+  power?: string;           // 'normal' | 'high' | 'low'
+  // 模型输入尺寸，默认 320x240（如 160x120 / 320x240 / 640x480）；
+  // 每种（模型, 尺寸）在注册表中单独加载，首次使用某尺寸时加载，切换回仍在内存预算内的尺寸时复用
+  inputWidth?: number;
+  inputHeight?: number;
+  letterbox?: boolean;      // 保持宽高比缩放到输入尺寸内（补黑边），默认拉伸
+  scoreThreshold?: number;  // 默认 0.95
+  iouThreshold?: number;    // NMS IoU 阈值，默认 0.3
+  maxFaces?: number;        // 最多返回的人脸数，0 表示不限制
+  // 自动调优线程数 / 精度 / 预处理滤波器：首次在 tuneImagePath 上计时并保存结果，
+  // 之后按模型哈希和 CPU 特征直接读取（覆盖 numThreads 和 precision）
+  autoTune?: boolean;
+  tuneImagePath?: string;
+  // detectFace* 的结果缓存（内存 LRU + 缓存目录中的文件，重启后仍有效），默认开启。
+  // 键为路径 + 修改时间 + 大小 + 模型和参数；cacheContentHash 改用文件内容哈希
+  cacheResults?: boolean;
+  cacheContentHash?: boolean;
+};
+
+// 视频模式（检测 + 光流跟踪）参数，所有字段可选
+export type TrackerOptions = {
+  detectInterval?: number;   // 每隔多少帧做一次全量检测，默认 5；1 表示每帧检测
+  minTrackQuality?: number;  // 光流可靠点比例低于它时立即重新检测，默认 0.5
+  matchIoU?: number;         // 检测框沿用已有轨迹 ID 的最小 IoU，默认 0.3
+  smoothing?: number;        // 检测帧保留旧框的权重 [0, 1)，默认 0.3
+};
+
+// 大图分块检测参数，所有字段可选
+export type TileOptions = {
+  tileScale?: number;     // tile 边长相对模型输入的倍数，默认 1（tile 像素直接送入模型）
+  overlap?: number;       // 相邻 tile 的重叠比例，默认 0.25
+  batchSize?: number;     // 每次推理的 tile 数，默认 4
+  coarsePass?: boolean;   // 额外做一次整图检测以找到大脸，默认 true
+};
+
+// 图库批量扫描参数，所有字段可选
+export type ScanOptions = {
+  decodeThreads?: number;     // 解码线程数，默认 CPU 核数的一半
+  inferThreads?: number;      // 推理线程数，默认 1（另一个 session 留给同步检测）
+  batchSize?: number;         // 每次推理的最大图像数，默认 4；只有默认值批量推理（session 在
+                              // initFaceDetector 时创建），其他值、letterbox 或非默认尺寸逐张推理
+  queueDepth?: number;        // 各阶段之间队列的容量，默认 16
+  progressInterval?: number;  // 每完成多少张回调一次，默认 32
+};
+
+export type FaceBox = {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+  score: number;
+};
+
 export interface Spec extends TurboModule {
   readonly reverseString: (input: string) => string;
   readonly addNumbers: (a: number, b: number) => number;
-  readonly initFaceDetector: () => string;  // 无需传参数，模型自动从 assets 加载
+  readonly initFaceDetector: (options?: DetectorOptions) => string;  // 模型自动从 assets 加载
   readonly detectFace: (imagePath: string) => string;
+  // 直接检测像素缓冲区，不经过文件和 imread；NV21/NV12 的 UV 平面需紧跟 Y 平面
+  readonly detectFaceInBuffer: (frame: PixelFrame) => string;
+  // 直接返回 JS 对象，不经过 JSON：packed=false 返回 FaceBox[]，
+  // packed=true 返回 Float32Array [x, y, w, h, score, ...]；出错时抛出异常（message 为错误 JSON）
+  readonly detectFaceTyped: (imagePath: string, packed: boolean) => Object;
+  readonly detectFaceInBufferTyped: (frame: PixelFrame, packed: boolean) => Object;
+  // 异步版本：在原生工作线程执行，不阻塞 JS 线程；按调用顺序 resolve
+  readonly initFaceDetectorAsync: (options?: DetectorOptions) => Promise<string>;
+  readonly detectFaceAsync: (imagePath: string) => Promise<string>;
+  // 大图（如合照）分块检测小脸：切成重叠的模型尺寸 tile 批量推理，结果格式同 detectFace
+  readonly detectFaceTiledAsync: (imagePath: string, options?: TileOptions) => Promise<string>;
+  // 批量扫描图库：I/O 预读、并行解码、批量推理、后处理四个阶段流水线执行。
+  // 立即返回 {jobId, total}；onProgress 收到 JSON
+  // {jobId, state, processed, total, cached, failed, results: [{index, faces} | {index, error, code}]}，
+  // results 只含上次回调以来完成的图像，index 为其在 paths 中的位置；
+  // 最后一次回调的 state 为 'done' 或 'cancelled'
+  readonly scanImages: (
+    paths: string[],
+    onProgress: (update: string) => void,
+    options?: ScanOptions,
+  ) => string;
+  readonly pauseScan: (jobId: number) => boolean;
+  readonly resumeScan: (jobId: number) => boolean;
+  readonly cancelScan: (jobId: number) => boolean;
+  // reject 所有尚未开始的异步调用，返回被取消的数量
+  readonly cancelPendingDetections: () => number;
+  // 只在 regions（通常是上一帧的结果）附近重新检测：每个框扩大 expand 倍（默认 2）后
+  // 以模型分辨率批量推理，结果为原帧坐标，格式同 detectFaceInBuffer
+  readonly detectFaceInRegions: (frame: PixelFrame, regions: FaceBox[], expand?: number) => string;
+  // 视频模式：设置跟踪参数并清空轨迹（切换摄像头时也可调用）；返回状态 JSON
+  readonly setFaceTrackerOptions: (options?: TrackerOptions) => string;
+  // 检测 + 跟踪一帧相机画面，大多数帧只做光流不推理。返回
+  // {faces: [{x, y, width, height, score, id}], detected}，id 在各帧之间保持不变，
+  // detected 表示本帧是否运行了全量检测
+  readonly trackFacesInBuffer: (frame: PixelFrame) => string;
+  // 已加载模型的内存预算（MB），超出时淘汰最久未使用的模型；0 表示不限制
+  readonly setModelMemoryBudget: (megabytes: number) => void;
+  // 模型注册表状态 JSON：{budgetMb, residentMb, loaded: ['id@宽x高'...], hits, loads, evictions}
+  readonly getModelStats: () => string;
+  // 结果缓存状态 JSON：{memoryHits, diskHits, misses, memoryEntries, diskEntries}
+  readonly getResultCacheStats: () => string;
+  // 清空内存和磁盘中缓存的结果，计数器归零
+  readonly clearResultCache: () => void;
+  // 各阶段耗时统计 JSON（毫秒，进程启动或上次 reset 以来）：
+  // {stages: {imageLoad, resize, convert, inference, outputCopy, anchorDecode, nms, detect,
+  //   serialize, request: {count, p50, p90, p99, max, mean}}}
+  readonly getPerfStats: () => string;
+  readonly resetPerfStats: () => void;
+  // 逐算子计时（runSessionWithCallBackInfo，有额外开销，只用于分析）：开启时清空统计，
+  // 检测器未初始化时返回 false
+  readonly setOpProfiling: (enabled: boolean) => boolean;
+  // 开启以来的统计 JSON（ms 为每次推理的平均值，share 为占所有算子耗时的比例）：
+  // {runs, totalMs, types: [{type, ops, ms, share, gflops}],
+  //  ops: [{name, type, ms, share, mflops, gflops}]}，ops 只含耗时最高的 topN 个（默认 20）
+  readonly getOpProfile: (topN?: number) => string;
 }
 
 export default TurboModuleRegistry.getEnforcing<Spec>(